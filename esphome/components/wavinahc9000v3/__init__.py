@@ -1,17 +1,32 @@
+import logging
+import math
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import uart, climate, number
-from esphome.const import CONF_ID
+import esphome.final_validate as fv
+from esphome.components import uart, climate
+from esphome.const import (
+    CONF_BAUD_RATE,
+    CONF_ID,
+    CONF_PLATFORM,
+    CONF_UPDATE_INTERVAL,
+    PLATFORM_ESP32,
+    PLATFORM_HOST,
+)
 from esphome import pins
+from esphome.core import CORE
+
+_LOGGER = logging.getLogger(__name__)
 
 CODEOWNERS = ["@you"]
-# Ensure dependent component code is compiled so their headers are available.
-AUTO_LOAD = ["climate", "uart", "sensor", "text_sensor", "switch", "binary_sensor"]
+# The hub itself needs only climate and uart; each entity platform loads its own component and defines
+# WAVIN_AHC9000_<PLATFORM>, so a climate-only config compiles no sensor/switch/number code.
+AUTO_LOAD = ["climate", "uart"]
 
 ns = cg.esphome_ns.namespace("wavinahc9000v3")
 WavinAHC9000 = ns.class_("WavinAHC9000", cg.PollingComponent, uart.UARTDevice)
 WavinZoneClimate = ns.class_("WavinZoneClimate", climate.Climate, cg.Component)
-WavinSetpointNumber = ns.class_("WavinSetpointNumber", number.Number)
+FaultProfile = ns.struct("FaultProfile")
 
 CONF_UART_ID = "uart_id"
 CONF_TX_ENABLE_PIN = "tx_enable_pin"
@@ -20,9 +35,186 @@ CONF_TEMP_DIVISOR = "temp_divisor"
 CONF_RECEIVE_TIMEOUT_MS = "receive_timeout_ms"
 CONF_POLL_CHANNELS_PER_CYCLE = "poll_channels_per_cycle"
 CONF_ALLOW_MODE_WRITES = "allow_mode_writes"
+CONF_MAX_PUBLISHES_PER_SECOND = "max_publishes_per_second"
+CONF_PUBLISH_POLICIES = "publish_policies"
+CONF_MIN_DELTA = "min_delta"
+CONF_HEARTBEAT = "heartbeat"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_HISTORY_WINDOW = "history_window"
+CONF_HISTORY_SAMPLES = "history_samples"
+CONF_CRC_TABLE = "crc_table"
+CONF_BUS_TRACE_SIZE = "bus_trace_size"
+CONF_FAULT_INJECTION = "fault_injection"
+CONF_WRITE_ELISION_MAX_AGE = "write_elision_max_age"
+CONF_REFRESH_INTERVAL = "refresh_interval"
+CONF_MODEL = "model"
+CONF_BUS_LOG_LEVEL = "bus_log_level"
+CONF_BUS_TRACING = "bus_tracing"
+CONF_SLOW_COMMAND_THRESHOLD = "slow_command_threshold"
+CONF_PROBE_SWEEP = "probe_sweep"
+CONF_FULL_READ_INTERVAL = "full_read_interval"
+CONF_IO_TASK = "io_task"
+CONF_ELEMENT_PHASE_POLLING = "element_phase_polling"
+CONF_IDENTITY_CHECK_INTERVAL = "identity_check_interval"
+
+# Controller models and their channel count; sizes the hub's state tables at compile time
+MODELS = {
+    "ahc9000": 16,
+    "ac116": 16,
+    "ahc9000_8": 8,
+}
+# Upper bound for the platform schemas; the configured model is checked at final validation
+MAX_CHANNELS = max(MODELS.values())
+CONF_DROP_RATE = "drop_rate"
+CONF_BIT_FLIP_RATE = "bit_flip_rate"
+CONF_TRUNCATE_RATE = "truncate_rate"
+CONF_SILENCE_RATE = "silence_rate"
+CONF_LATENCY = "latency"
+CONF_TX_ECHO = "tx_echo"
+
+# Match PublishPolicyClass in wavin_ahc9000.h; values are the defaults (min_delta, heartbeat, min_interval)
+PUBLISH_POLICY_CLASSES = {
+    "temperature": (0, 0.1, "15min", "0s"),
+    "setpoint": (1, 0.1, "15min", "0s"),
+    "rssi": (2, 2.0, "30min", "60s"),
+    "battery": (3, 10.0, "60min", "0s"),
+    "state": (4, 0.5, "15min", "0s"),
+    "statistics": (5, 1.0, "15min", "60s"),
+    "trend": (6, 0.05, "15min", "60s"),
+}
+
+
+def _publish_policy_schema(min_delta, heartbeat, min_interval):
+    return cv.Schema(
+        {
+            cv.Optional(CONF_MIN_DELTA, default=min_delta): cv.float_range(min=0.0),
+            cv.Optional(CONF_HEARTBEAT, default=heartbeat): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_MIN_INTERVAL, default=min_interval): cv.positive_time_period_milliseconds,
+        }
+    )
+
+
+PUBLISH_POLICIES_SCHEMA = cv.Schema(
+    {
+        cv.Optional(name, default={}): _publish_policy_schema(*defaults)
+        for name, (_, *defaults) in PUBLISH_POLICY_CLASSES.items()
+    }
+)
+
+# Per-channel refresh classes for the platforms' refresh_interval option; "normal" keeps the
+# round-robin period implied by update_interval and poll_channels_per_cycle
+REFRESH_CLASSES = {"fast": 15000, "normal": None, "slow": 300000}
+
+
+def refresh_interval(value):
+    """Accepts a refresh class name or a time period; returns milliseconds or None."""
+    if isinstance(value, str) and value.lower() in REFRESH_CLASSES:
+        return REFRESH_CLASSES[value.lower()]
+    return cv.positive_time_period_milliseconds(value).total_milliseconds
+
+
+def add_refresh_interval(hub, config, channels):
+    interval = config.get(CONF_REFRESH_INTERVAL)
+    if interval is None:
+        return
+    for ch in channels:
+        cg.add(hub.set_channel_refresh_interval(ch, interval))
+
+
+# Registers per transaction of one channel read set; keep in sync with the read plans in wavin_ahc9000.h
+READ_SET_SPANS = [3, 1, 5, 1, 2, 7]
+# Status and element block only: a probe sweep's read set when nothing changed
+PROBE_SPANS = [3, 7]
+# Request frame bytes, response overhead bytes and an allowance for controller turnaround
+_REQUEST_BYTES = 8
+_RESPONSE_OVERHEAD = 5
+_TURNAROUND_S = 0.015
+# The hub runs one transaction per loop() call
+_LOOP_INTERVAL_S = 0.016
+
+
+def _read_set_seconds(baud, spans=READ_SET_SPANS):
+    total = 0.0
+    for count in spans:
+        wire = (_REQUEST_BYTES + _RESPONSE_OVERHEAD + 2 * count) * 10 / baud
+        total += max(wire + _TURNAROUND_S, _LOOP_INTERVAL_S)
+    return total
+
+
+def _final_validate(config):
+    full = fv.full_config.get()
+    hub_id = config[CONF_ID].id
+    channels = set()
+    requested = {}
+    for domain, items in full.items():
+        if not isinstance(items, list):
+            continue
+        for item in items:
+            if not isinstance(item, dict) or item.get(CONF_PLATFORM) != "wavinahc9000v3":
+                continue
+            parent = item.get("wavinahc9000v3_id")
+            if parent is None or parent.id != hub_id:
+                continue
+            members = item.get("members") or ([item["channel"]] if "channel" in item else [])
+            channels.update(members)
+            interval = item.get(CONF_REFRESH_INTERVAL)
+            if interval:
+                for ch in members:
+                    requested[ch] = min(requested.get(ch, interval), interval)
+    model_channels = MODELS[config[CONF_MODEL]]
+    beyond = sorted(ch for ch in channels if ch > model_channels)
+    if beyond:
+        raise cv.Invalid(
+            f"Channel(s) {', '.join(map(str, beyond))} not available on model {config[CONF_MODEL]} "
+            f"({model_channels} channels)"
+        )
+    if not channels:
+        channels = set(range(1, model_channels + 1))
+
+    per_cycle = config[CONF_POLL_CHANNELS_PER_CYCLE]
+    update_s = config[CONF_UPDATE_INTERVAL].total_milliseconds / 1000
+    default_s = math.ceil(len(channels) / per_cycle) * update_s
+    demand = sum(1000 / requested[ch] if ch in requested else 1 / default_s for ch in channels)
+
+    schedule_capacity = per_cycle / update_s
+    if demand > schedule_capacity:
+        _LOGGER.warning(
+            "wavinahc9000v3: requested refresh rates need %.2f channel reads/s but update_interval %.0fs with "
+            "poll_channels_per_cycle %d schedules at most %.2f/s; slower channels will lag",
+            demand, update_s, per_cycle, schedule_capacity,
+        )
+    uart_path = full.get_path_for_id(config[CONF_UART_ID])[:-1]
+    baud = full.get_config_for_path(uart_path).get(CONF_BAUD_RATE)
+    if baud:
+        read_set_s = _read_set_seconds(baud)
+        if config[CONF_PROBE_SWEEP]:
+            # Assume mostly unchanged channels plus one full read per channel and full_read_interval
+            full_share = min(1.0, 1 / (demand * config[CONF_FULL_READ_INTERVAL].total_milliseconds / 1000 / len(channels)))
+            read_set_s = full_share * read_set_s + (1 - full_share) * _read_set_seconds(baud, PROBE_SPANS)
+        if demand * read_set_s > 0.8:
+            _LOGGER.warning(
+                "wavinahc9000v3: requested refresh rates need %.0f%% of the bus at %d baud "
+                "(about %.0fms per channel read); expect refreshes to lag and writes to wait",
+                100 * demand * read_set_s, baud, 1000 * read_set_s,
+            )
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate
+
+# Test-only bus impairments; the code is compiled in only when this block is present
+FAULT_INJECTION_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_DROP_RATE, default=0.0): cv.float_range(min=0.0, max=1.0),
+        cv.Optional(CONF_BIT_FLIP_RATE, default=0.0): cv.float_range(min=0.0, max=1.0),
+        cv.Optional(CONF_TRUNCATE_RATE, default=0.0): cv.float_range(min=0.0, max=1.0),
+        cv.Optional(CONF_SILENCE_RATE, default=0.0): cv.float_range(min=0.0, max=1.0),
+        cv.Optional(CONF_LATENCY, default="0ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_TX_ECHO, default=False): cv.boolean,
+    }
+)
 
 _FRIENDLY_NAME_KEYS = {
-    cv.Optional(f"channel_{i:02d}_friendly_name"): cv.string for i in range(1, 17)
+    cv.Optional(f"channel_{i:02d}_friendly_name"): cv.string for i in range(1, MAX_CHANNELS + 1)
 }
 
 CONFIG_SCHEMA = (
@@ -34,8 +226,43 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_FLOW_CONTROL_PIN): pins.gpio_output_pin_schema,
             cv.Optional(CONF_TEMP_DIVISOR, default=10.0): cv.positive_float,
             cv.Optional(CONF_RECEIVE_TIMEOUT_MS, default=1000): cv.positive_int,
-            cv.Optional(CONF_POLL_CHANNELS_PER_CYCLE, default=2): cv.int_range(min=1, max=16),
+            cv.Optional(CONF_MODEL, default="ahc9000"): cv.one_of(*MODELS, lower=True),
+            cv.Optional(CONF_POLL_CHANNELS_PER_CYCLE, default=2): cv.int_range(min=1, max=MAX_CHANNELS),
             cv.Optional(CONF_ALLOW_MODE_WRITES, default=True): cv.boolean,
+            cv.Optional(CONF_MAX_PUBLISHES_PER_SECOND, default=20): cv.int_range(min=1, max=1000),
+            cv.Optional(CONF_PUBLISH_POLICIES, default={}): PUBLISH_POLICIES_SCHEMA,
+            # Sliding window for trend / duty-cycle sensors (4 bytes per sample per channel using them)
+            cv.Optional(CONF_HISTORY_WINDOW, default="1h"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(minutes=10), max=cv.TimePeriod(hours=9)),
+            ),
+            cv.Optional(CONF_HISTORY_SAMPLES, default=96): cv.int_range(min=8, max=1024),
+            # CRC16 lookup table: full (512 bytes) or nibble (32 bytes); auto picks nibble on ESP8266
+            cv.Optional(CONF_CRC_TABLE, default="auto"): cv.one_of("auto", "full", "nibble", lower=True),
+            # Raw frame capture for diagnostics (bytes of RAM, 0 disables)
+            cv.Optional(CONF_BUS_TRACE_SIZE, default=0): cv.int_range(min=0, max=16384),
+            # Skip writes that match a read-back no older than this (0s disables)
+            cv.Optional(CONF_WRITE_ELISION_MAX_AGE, default="120s"): cv.positive_time_period_milliseconds,
+            # Per-transaction DEBUG logs are only compiled in at "debug"; bus_tracing is the runtime switch
+            cv.Optional(CONF_BUS_LOG_LEVEL, default="info"): cv.one_of("info", "debug", lower=True),
+            cv.Optional(CONF_BUS_TRACING, default=True): cv.boolean,
+            # Commands taking longer than this from control call to published state are logged with a stage breakdown
+            cv.Optional(CONF_SLOW_COMMAND_THRESHOLD, default="5s"): cv.positive_time_period_milliseconds,
+            # Routine polls read status + element first and the rest only on change, after writes or
+            # once the last full read is older than full_read_interval
+            cv.Optional(CONF_PROBE_SWEEP, default=False): cv.boolean,
+            cv.Optional(CONF_FULL_READ_INTERVAL, default="5min"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(seconds=30)),
+            ),
+            # Learn when each wireless element reports and read its block just after, not every poll
+            cv.Optional(CONF_ELEMENT_PHASE_POLLING, default=False): cv.boolean,
+            # Re-read the controller identity this often; a swap, or an answer after an outage, triggers a resync
+            cv.Optional(CONF_IDENTITY_CHECK_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_FAULT_INJECTION): FAULT_INJECTION_SCHEMA,
+            # Bus I/O on a dedicated task (second core on ESP32, a thread on host builds); every bus
+            # job is posted to it and completed on a later loop(), so the main loop never waits
+            cv.Optional(CONF_IO_TASK): cv.All(cv.boolean, cv.only_on([PLATFORM_ESP32, PLATFORM_HOST])),
             **_FRIENDLY_NAME_KEYS,
         }
     )
@@ -47,6 +274,10 @@ CONFIG_SCHEMA = (
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
+    cg.add_define("WAVIN_AHC9000_CHANNELS", MODELS[config[CONF_MODEL]])
+    crc_table = config[CONF_CRC_TABLE]
+    if crc_table == "nibble" or (crc_table == "auto" and CORE.is_esp8266):
+        cg.add_define("WAVIN_AHC9000_CRC_NIBBLE")
     await uart.register_uart_device(var, config)
     await cg.register_component(var, config)
     if CONF_TX_ENABLE_PIN in config:
@@ -63,6 +294,54 @@ async def to_code(config):
         cg.add(var.set_poll_channels_per_cycle(config[CONF_POLL_CHANNELS_PER_CYCLE]))
     if CONF_ALLOW_MODE_WRITES in config:
         cg.add(var.set_allow_mode_writes(config[CONF_ALLOW_MODE_WRITES]))
+    if CONF_MAX_PUBLISHES_PER_SECOND in config:
+        cg.add(var.set_max_publishes_per_second(config[CONF_MAX_PUBLISHES_PER_SECOND]))
+    if CONF_HISTORY_WINDOW in config:
+        cg.add(var.set_history_window_ms(config[CONF_HISTORY_WINDOW].total_milliseconds))
+    if CONF_HISTORY_SAMPLES in config:
+        cg.add(var.set_history_samples(config[CONF_HISTORY_SAMPLES]))
+    if config.get(CONF_BUS_TRACE_SIZE, 0) > 0:
+        cg.add(var.set_bus_trace_size(config[CONF_BUS_TRACE_SIZE]))
+    if CONF_WRITE_ELISION_MAX_AGE in config:
+        cg.add(var.set_write_elision_max_age_ms(config[CONF_WRITE_ELISION_MAX_AGE].total_milliseconds))
+    if config[CONF_BUS_LOG_LEVEL] == "debug":
+        cg.add_define("WAVIN_AHC9000_BUS_LOG_LEVEL", "ESPHOME_LOG_LEVEL_DEBUG")
+    cg.add(var.set_bus_tracing(config[CONF_BUS_TRACING]))
+    cg.add(var.set_slow_command_threshold_ms(config[CONF_SLOW_COMMAND_THRESHOLD].total_milliseconds))
+    cg.add(var.set_identity_check_interval_ms(config[CONF_IDENTITY_CHECK_INTERVAL].total_milliseconds))
+    if config[CONF_ELEMENT_PHASE_POLLING]:
+        cg.add(var.set_element_phase_polling(True))
+    if config.get(CONF_IO_TASK):
+        cg.add_define("WAVIN_AHC9000_IO_TASK")
+        cg.add(var.set_io_task(True))
+    if config[CONF_PROBE_SWEEP]:
+        cg.add(var.set_probe_sweep(True))
+        cg.add(var.set_full_read_interval_ms(config[CONF_FULL_READ_INTERVAL].total_milliseconds))
+    if CONF_FAULT_INJECTION in config:
+        fault = config[CONF_FAULT_INJECTION]
+        cg.add_define("WAVIN_AHC9000_FAULT_INJECTION")
+        cg.add(
+            var.set_fault_profile(
+                cg.StructInitializer(
+                    FaultProfile,
+                    ("drop_rate", fault[CONF_DROP_RATE]),
+                    ("bit_flip_rate", fault[CONF_BIT_FLIP_RATE]),
+                    ("truncate_rate", fault[CONF_TRUNCATE_RATE]),
+                    ("silence_rate", fault[CONF_SILENCE_RATE]),
+                    ("latency_ms", fault[CONF_LATENCY].total_milliseconds),
+                    ("tx_echo", fault[CONF_TX_ECHO]),
+                )
+            )
+        )
+    for name, policy in config.get(CONF_PUBLISH_POLICIES, {}).items():
+        cg.add(
+            var.set_publish_policy(
+                PUBLISH_POLICY_CLASSES[name][0],
+                policy[CONF_MIN_DELTA],
+                policy[CONF_HEARTBEAT].total_milliseconds,
+                policy[CONF_MIN_INTERVAL].total_milliseconds,
+            )
+        )
 
     # Parse channel friendly names
     for key, value in config.items():
@@ -70,10 +349,10 @@ async def to_code(config):
             continue
         if key.startswith("channel_") and key.endswith("_friendly_name"):
             mid = key[len("channel_") : -len("_friendly_name")]
-            # Accept both zero-padded and non-padded integers 1..16
+            # Accept both zero-padded and non-padded channel numbers
             try:
                 ch = int(mid)
             except ValueError:
                 continue
-            if 1 <= ch <= 16:
+            if 1 <= ch <= MODELS[config[CONF_MODEL]]:
                 cg.add(var.set_channel_friendly_name(ch, value))
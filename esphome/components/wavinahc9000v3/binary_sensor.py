@@ -3,7 +3,7 @@ import esphome.config_validation as cv
 from esphome.components import binary_sensor
 from esphome.const import CONF_CHANNEL, CONF_TYPE
 
-from . import WavinAHC9000
+from . import WavinAHC9000, MAX_CHANNELS
 
 CONF_PARENT_ID = "wavinahc9000v3_id"
 
@@ -13,13 +13,14 @@ TYPE_PROBLEM = "problem"
 CONFIG_SCHEMA = binary_sensor.binary_sensor_schema().extend(
     {
         cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
-        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=16),
+        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=MAX_CHANNELS),
         cv.Required(CONF_TYPE): cv.one_of(TYPE_OUTPUT, TYPE_PROBLEM, lower=True),
     }
 )
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_PARENT_ID])
+    cg.add_define("WAVIN_AHC9000_BINARY_SENSOR")
     var = await binary_sensor.new_binary_sensor(config)
     
     if config[CONF_TYPE] == TYPE_OUTPUT:
@@ -3,12 +3,19 @@ import esphome.config_validation as cv
 from esphome.components import button
 from esphome.const import CONF_ID
 
-from . import WavinAHC9000
+from . import WavinAHC9000, MAX_CHANNELS
 
 CONF_PARENT_ID = "wavinahc9000v3_id"
 CONF_CHANNEL = "channel"
+CONF_TYPE = "type"
+
+TYPE_REPAIR = "repair"
+TYPE_DUMP_TRACE = "dump_trace"
+TYPE_DUMP_REGISTERS = "dump_registers"
 
 WavinRepairButton = cg.esphome_ns.namespace("wavinahc9000v3").class_("WavinRepairButton", button.Button, cg.Component)
+WavinTraceDumpButton = cg.esphome_ns.namespace("wavinahc9000v3").class_("WavinTraceDumpButton", button.Button)
+WavinRegisterDumpButton = cg.esphome_ns.namespace("wavinahc9000v3").class_("WavinRegisterDumpButton", button.Button)
 
 # Optional extended repair clears additional flags that may lock keypad
 CONF_EXTENDED = "extended"
@@ -16,20 +23,43 @@ CONF_AGGRESSIVE = "aggressive"
 CONF_NORMALIZE = "normalize"
 CONF_NORMALIZE_OFF = "normalize_off"
 
-CONFIG_SCHEMA = button.button_schema(WavinRepairButton).extend(
+CONFIG_SCHEMA = cv.typed_schema(
     {
-        cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
-        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=16),
-    cv.Optional(CONF_EXTENDED, default=False): cv.boolean,
-    cv.Optional(CONF_AGGRESSIVE, default=False): cv.boolean,
-    cv.Optional(CONF_NORMALIZE, default=False): cv.boolean,
-    cv.Optional(CONF_NORMALIZE_OFF, default=False): cv.boolean,
-    }
+        TYPE_REPAIR: button.button_schema(WavinRepairButton).extend(
+            {
+                cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
+                cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=MAX_CHANNELS),
+            cv.Optional(CONF_EXTENDED, default=False): cv.boolean,
+            cv.Optional(CONF_AGGRESSIVE, default=False): cv.boolean,
+            cv.Optional(CONF_NORMALIZE, default=False): cv.boolean,
+            cv.Optional(CONF_NORMALIZE_OFF, default=False): cv.boolean,
+            }
+        ),
+        # Logs the hub's raw bus trace (see bus_trace_size)
+        TYPE_DUMP_TRACE: button.button_schema(WavinTraceDumpButton).extend(
+            {
+                cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
+            }
+        ),
+        # Starts a background read of all controller registers (see start_register_dump)
+        TYPE_DUMP_REGISTERS: button.button_schema(WavinRegisterDumpButton).extend(
+            {
+                cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
+            }
+        ),
+    },
+    key=CONF_TYPE,
+    default_type=TYPE_REPAIR,
+    lower=True,
 )
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_PARENT_ID])
+    cg.add_define("WAVIN_AHC9000_BUTTON")
     btn = await button.new_button(config)
+    if config[CONF_TYPE] in (TYPE_DUMP_TRACE, TYPE_DUMP_REGISTERS):
+        cg.add(btn.set_parent(hub))
+        return
     cg.add(btn.set_parent(hub))
     cg.add(btn.set_channel(config[CONF_CHANNEL]))
     cg.add(btn.set_extended(config[CONF_EXTENDED]))
@@ -3,7 +3,7 @@ import esphome.config_validation as cv
 from esphome.components import climate
 from esphome.const import CONF_ID, CONF_NAME
 
-from . import WavinAHC9000, WavinZoneClimate
+from . import WavinAHC9000, WavinZoneClimate, CONF_REFRESH_INTERVAL, add_refresh_interval, refresh_interval, MAX_CHANNELS
 
 CONF_PARENT_ID = "wavinahc9000v3_id"
 CONF_CHANNEL = "channel"
@@ -17,10 +17,12 @@ CONF_USE_FLOOR_TEMPERATURE = "use_floor_temperature"
 CONFIG_SCHEMA = climate.climate_schema(WavinZoneClimate).extend(
     {
         cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
-        cv.Optional(CONF_CHANNEL): cv.int_range(min=1, max=16),
-        cv.Optional(CONF_MEMBERS): cv.ensure_list(cv.int_range(min=1, max=16)),
+        cv.Optional(CONF_CHANNEL): cv.int_range(min=1, max=MAX_CHANNELS),
+        cv.Optional(CONF_MEMBERS): cv.ensure_list(cv.int_range(min=1, max=MAX_CHANNELS)),
         cv.Optional(CONF_STRICT_MODE_WRITES, default=False): cv.boolean,
         cv.Optional(CONF_USE_FLOOR_TEMPERATURE, default=False): cv.boolean,
+        # fast / normal / slow or a time period; applies to the channel or every group member
+        cv.Optional(CONF_REFRESH_INTERVAL): refresh_interval,
     }
 )
 
@@ -44,3 +46,4 @@ async def to_code(config):
         for ch in config[CONF_MEMBERS]:
             cg.add(hub.add_active_channel(ch))
         cg.add(hub.add_group_climate(var))
+    add_refresh_interval(hub, config, [config[CONF_CHANNEL]] if CONF_CHANNEL in config else config.get(CONF_MEMBERS, []))
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace wavinahc9000v3 {
+
+// Modbus CRC16 (0xA001 poly, reflected). Three interchangeable per-byte updates:
+//   bitwise: 8 shift/xor rounds, no table (reference)
+//   nibble:  16-entry table (32 bytes), two lookups per byte
+//   byte:    256-entry table (512 bytes), one lookup per byte
+// The tables are generated at compile time. crc16_update() picks the byte table by default, or the
+// nibble table when WAVIN_AHC9000_CRC_NIBBLE is defined for memory-constrained ESP8266 builds, where
+// constant arrays end up in RAM. Kept free of ESPHome dependencies so host tools can include it.
+constexpr uint16_t crc16_bitwise(uint16_t crc, uint8_t bits) {
+  for (uint8_t j = 0; j < bits; j++) crc = (crc & 0x0001) ? (uint16_t) ((crc >> 1) ^ 0xA001) : (uint16_t) (crc >> 1);
+  return crc;
+}
+template<size_t N> struct CrcTable {
+  uint16_t v[N];
+};
+template<size_t N> constexpr CrcTable<N> make_crc_table() {
+  CrcTable<N> t{};
+  for (size_t i = 0; i < N; i++) t.v[i] = crc16_bitwise((uint16_t) i, N == 256 ? 8 : 4);
+  return t;
+}
+// Only the table a build actually uses is emitted
+inline constexpr CrcTable<16> CRC16_NIBBLE_TABLE = make_crc_table<16>();
+inline constexpr CrcTable<256> CRC16_BYTE_TABLE = make_crc_table<256>();
+
+inline uint16_t crc16_update_bitwise(uint16_t crc, uint8_t b) { return crc16_bitwise((uint16_t) (crc ^ b), 8); }
+inline uint16_t crc16_update_nibble(uint16_t crc, uint8_t b) {
+  crc ^= b;
+  crc = (uint16_t) ((crc >> 4) ^ CRC16_NIBBLE_TABLE.v[crc & 0x0F]);
+  return (uint16_t) ((crc >> 4) ^ CRC16_NIBBLE_TABLE.v[crc & 0x0F]);
+}
+inline uint16_t crc16_update_byte(uint16_t crc, uint8_t b) {
+  return (uint16_t) ((crc >> 8) ^ CRC16_BYTE_TABLE.v[(crc ^ b) & 0xFF]);
+}
+
+inline uint16_t crc16_update(uint16_t crc, uint8_t b) {
+#ifdef WAVIN_AHC9000_CRC_NIBBLE
+  return crc16_update_nibble(crc, b);
+#else
+  return crc16_update_byte(crc, b);
+#endif
+}
+
+inline uint16_t crc16(const uint8_t *frame, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) crc = crc16_update(crc, frame[i]);
+  return crc;
+}
+
+// Streaming CRC state fed byte by byte while receiving. A complete frame including its trailing
+// CRC bytes leaves the state at zero, so validation costs nothing once the last byte lands.
+struct Crc16Stream {
+  uint16_t value{0xFFFF};
+  void reset() { this->value = 0xFFFF; }
+  void update(uint8_t b) { this->value = crc16_update(this->value, b); }
+  bool frame_ok() const { return this->value == 0; }
+};
+
+}  // namespace wavinahc9000v3
+}  // namespace esphome
@@ -2,12 +2,14 @@ import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import number
 from esphome.const import CONF_ID, CONF_NAME
-from . import WavinAHC9000, WavinSetpointNumber
+from . import WavinAHC9000, ns, MAX_CHANNELS
 
 CONF_PARENT_ID = "wavinahc9000v3_id"
 CONF_CHANNEL = "channel"
 CONF_TYPE = "type"
 
+WavinSetpointNumber = ns.class_("WavinSetpointNumber", number.Number)
+
 SETPOINT_TYPES = ["comfort", "standby", "hysteresis"]
 
 # Match the static constexpr values in WavinSetpointNumber
@@ -20,7 +22,7 @@ SETPOINT_TYPE_VALUES = {
 CONFIG_SCHEMA = number.number_schema(WavinSetpointNumber).extend(
     {
         cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
-        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=16),
+        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=MAX_CHANNELS),
         cv.Required(CONF_TYPE): cv.one_of(*SETPOINT_TYPES, lower=True),
     }
 )
@@ -28,6 +30,7 @@ CONFIG_SCHEMA = number.number_schema(WavinSetpointNumber).extend(
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_PARENT_ID])
+    cg.add_define("WAVIN_AHC9000_NUMBER")
     var = cg.new_Pvariable(config[CONF_ID])
 
     if config[CONF_TYPE] == "hysteresis":
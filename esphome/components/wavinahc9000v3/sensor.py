@@ -8,28 +8,58 @@ from esphome.const import (
     DEVICE_CLASS_TEMPERATURE,
     UNIT_CELSIUS,
     UNIT_DECIBEL,
+    UNIT_HOUR,
+    UNIT_MILLISECOND,
+    ICON_TIMER,
+    ENTITY_CATEGORY_DIAGNOSTIC,
 )
 
-from . import WavinAHC9000
+from . import WavinAHC9000, CONF_REFRESH_INTERVAL, add_refresh_interval, refresh_interval, MAX_CHANNELS
 
 CONF_PARENT_ID = "wavinahc9000v3_id"
 CONF_CHANNEL = "channel"
 
 
 CONF_TYPE = "type"
+UNIT_CELSIUS_PER_HOUR = "°C/h"
+# Hub-wide sensors; every other type belongs to a channel
+HUB_TYPES = ("command_latency_p50", "command_latency_p95")
 
-CONFIG_SCHEMA = sensor.sensor_schema().extend(
+
+def _validate_channel(config):
+    if config[CONF_TYPE] in HUB_TYPES:
+        if CONF_CHANNEL in config:
+            raise cv.Invalid(f"'{config[CONF_TYPE]}' is a hub sensor and takes no channel")
+    elif CONF_CHANNEL not in config:
+        raise cv.Invalid(f"'{config[CONF_TYPE]}' requires a channel")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(sensor.sensor_schema().extend(
     {
         cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
-        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=16),
-    cv.Required(CONF_TYPE): cv.one_of("battery", "temperature", "comfort_setpoint", "floor_temperature", "floor_min_temperature", "floor_max_temperature", "rssi_element", "rssi_cu", lower=True),
+        cv.Optional(CONF_CHANNEL): cv.int_range(min=1, max=MAX_CHANNELS),
+        # fast / normal / slow or a time period; the hub polls the channel at the shortest one requested
+        cv.Optional(CONF_REFRESH_INTERVAL): refresh_interval,
+    cv.Required(CONF_TYPE): cv.one_of("battery", "temperature", "comfort_setpoint", "floor_temperature", "floor_min_temperature", "floor_max_temperature", "rssi_element", "rssi_cu", "temperature_trend", "floor_temperature_trend", "duty_cycle", "on_time", *HUB_TYPES, lower=True),
     }
-)
+), _validate_channel)
 
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_PARENT_ID])
+    cg.add_define("WAVIN_AHC9000_SENSOR")
     sens = await sensor.new_sensor(config)
+    if config[CONF_TYPE] in HUB_TYPES:
+        # Rolling percentile of control-call-to-published-state latency over the last 32 commands
+        cg.add(sens.set_unit_of_measurement(UNIT_MILLISECOND))
+        cg.add(sens.set_accuracy_decimals(0))
+        cg.add(sens.set_entity_category(ENTITY_CATEGORY_DIAGNOSTIC))
+        if config[CONF_TYPE] == "command_latency_p50":
+            cg.add(hub.set_command_latency_p50_sensor(sens))
+        else:
+            cg.add(hub.set_command_latency_p95_sensor(sens))
+        return
     # Apply defaults based on sensor type
     if config[CONF_TYPE] == "battery":
         cg.add(sens.set_device_class(DEVICE_CLASS_BATTERY))
@@ -45,6 +75,25 @@ async def to_code(config):
         cg.add(sens.set_unit_of_measurement(UNIT_DECIBEL))
         cg.add(sens.set_accuracy_decimals(1))
         cg.add(hub.add_channel_rssi_cu_sensor(config[CONF_CHANNEL], sens))
+    elif config[CONF_TYPE] in ("temperature_trend", "floor_temperature_trend"):
+        # Least-squares slope over the hub's history_window
+        cg.add(sens.set_unit_of_measurement(UNIT_CELSIUS_PER_HOUR))
+        cg.add(sens.set_accuracy_decimals(2))
+        if config[CONF_TYPE] == "temperature_trend":
+            cg.add(hub.add_channel_temperature_trend_sensor(config[CONF_CHANNEL], sens))
+        else:
+            cg.add(hub.add_channel_floor_temperature_trend_sensor(config[CONF_CHANNEL], sens))
+    elif config[CONF_TYPE] == "duty_cycle":
+        # Share of history_window with the channel output (valve) on
+        cg.add(sens.set_unit_of_measurement(UNIT_PERCENT))
+        cg.add(sens.set_accuracy_decimals(0))
+        cg.add(hub.add_channel_duty_cycle_sensor(config[CONF_CHANNEL], sens))
+    elif config[CONF_TYPE] == "on_time":
+        # Output on-time over the last 24 hours
+        cg.add(sens.set_unit_of_measurement(UNIT_HOUR))
+        cg.add(sens.set_icon(ICON_TIMER))
+        cg.add(sens.set_accuracy_decimals(2))
+        cg.add(hub.add_channel_on_time_sensor(config[CONF_CHANNEL], sens))
     # yaml_ready numeric sensor removed in favor of binary_sensor platform
     else:
         # temperature & comfort_setpoint share temperature meta
@@ -62,3 +111,4 @@ async def to_code(config):
         else:
             cg.add(hub.add_channel_temperature_sensor(config[CONF_CHANNEL], sens))
     cg.add(hub.add_active_channel(config[CONF_CHANNEL]))
+    add_refresh_interval(hub, config, [config[CONF_CHANNEL]])
@@ -3,7 +3,7 @@ import esphome.config_validation as cv
 from esphome.components import switch
 from esphome.const import CONF_CHANNEL
 
-from . import WavinAHC9000, ns
+from . import WavinAHC9000, ns, MAX_CHANNELS
 
 CONF_PARENT_ID = "wavinahc9000v3_id"
 CONF_TYPE = "type"
@@ -18,13 +18,14 @@ SWITCH_TYPE_VALUES = {
 CONFIG_SCHEMA = switch.switch_schema(WavinSwitch).extend(
     {
         cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
-        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=16),
+        cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=MAX_CHANNELS),
         cv.Optional(CONF_TYPE, default="child_lock"): cv.one_of("child_lock", "standby", lower=True),
     }
 )
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_PARENT_ID])
+    cg.add_define("WAVIN_AHC9000_SWITCH")
     ch = config[CONF_CHANNEL]
     var = await switch.new_switch(config)
     cg.add(var.set_parent(hub))
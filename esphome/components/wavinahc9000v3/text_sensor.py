@@ -10,17 +10,19 @@ CONF_TYPE = "type"
 TYPE_SOFTWARE_VERSION = "software_version"
 TYPE_HARDWARE_VERSION = "hardware_version"
 TYPE_DEVICE_NAME = "device_name"
+TYPE_REGISTER_DUMP = "register_dump"
 
 CONFIG_SCHEMA = text_sensor.text_sensor_schema().extend(
     {
         cv.GenerateID("wavinahc9000v3_id"): cv.use_id(WavinAHC9000),
-        cv.Required(CONF_TYPE): cv.one_of(TYPE_SOFTWARE_VERSION, TYPE_HARDWARE_VERSION, TYPE_DEVICE_NAME, lower=True),
+        cv.Required(CONF_TYPE): cv.one_of(TYPE_SOFTWARE_VERSION, TYPE_HARDWARE_VERSION, TYPE_DEVICE_NAME, TYPE_REGISTER_DUMP, lower=True),
     }
 )
 
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_PARENT_ID])
+    cg.add_define("WAVIN_AHC9000_TEXT_SENSOR")
     ts = await text_sensor.new_text_sensor(config)
 
     typ = config[CONF_TYPE]
@@ -30,3 +32,6 @@ async def to_code(config):
         cg.add(hub.set_hardware_version_sensor(ts))
     elif typ == TYPE_DEVICE_NAME:
         cg.add(hub.set_device_name_sensor(ts))
+    elif typ == TYPE_REGISTER_DUMP:
+        # Receives each dump chunk in turn while a register dump runs
+        cg.add(hub.set_register_dump_sensor(ts))
@@ -1,250 +1,400 @@
 #include "wavin_ahc9000.h"
+#include "crc16.h"
 #include "esphome/core/application.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
-#include "esphome/components/sensor/sensor.h"
-#include "esphome/components/binary_sensor/binary_sensor.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#ifdef WAVIN_AHC9000_IO_TASK
+#ifdef USE_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+#endif
 
 namespace esphome {
 namespace wavinahc9000v3 {
 
 static const char *const TAG = "wavin_ahc9000";
 
-// Helper function to convert raw RSSI byte value to dBm
-// raw value 0x00 = -74 dBm, each step is +0.5 dBm
-// Treats raw as signed 8-bit integer
-static float raw_rssi_to_dbm(uint8_t raw) {
-  int8_t signed_raw = (int8_t) raw;
-  return -74.0f + (signed_raw * 0.5f);
-}
+// Entity platforms compiled into this build (see the WAVIN_AHC9000_<PLATFORM> defines in the header)
+static const char *const ENTITY_PLATFORMS = "climate"
+#ifdef WAVIN_AHC9000_SENSOR
+                                            " sensor"
+#endif
+#ifdef WAVIN_AHC9000_BINARY_SENSOR
+                                            " binary_sensor"
+#endif
+#ifdef WAVIN_AHC9000_TEXT_SENSOR
+                                            " text_sensor"
+#endif
+#ifdef WAVIN_AHC9000_SWITCH
+                                            " switch"
+#endif
+#ifdef WAVIN_AHC9000_NUMBER
+                                            " number"
+#endif
+#ifdef WAVIN_AHC9000_BUTTON
+                                            " button"
+#endif
+    ;
 
-// Simple Modbus CRC16 (0xA001 poly)
-static uint16_t crc16(const uint8_t *frame, size_t len) {
-  uint16_t temp = 0xFFFF;
-  for (size_t i = 0; i < len; i++) {
-    temp ^= frame[i];
-    for (uint8_t j = 0; j < 8; j++) {
-      bool flag = temp & 0x0001;
-      temp >>= 1;
-      if (flag) temp ^= 0xA001;
-    }
-  }
-  return temp;
-}
+// Hot-path logging (per transaction and per read step). Compiled in only when bus_log_level is
+// DEBUG, and then gated at runtime by set_bus_tracing() so it can be switched without reflashing.
+#ifndef WAVIN_AHC9000_BUS_LOG_LEVEL
+#define WAVIN_AHC9000_BUS_LOG_LEVEL ESPHOME_LOG_LEVEL_INFO
+#endif
+#if WAVIN_AHC9000_BUS_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+#define BUS_LOGD(...) \
+  do { \
+    if (this->bus_tracing_) \
+      ESP_LOGD(TAG, __VA_ARGS__); \
+  } while (0)
+#else
+#define BUS_LOGD(...) \
+  do { \
+  } while (0)
+#endif
 
 void WavinAHC9000::setup() { 
   ESP_LOGCONFIG(TAG, "Wavin AHC9000 hub setup");
-  // Default to all 1..16 if none explicitly configured via YAML
+  // Default to every channel of the model if none explicitly configured via YAML
   if (this->active_channels_.empty()) {
-    this->active_channels_.reserve(16);
-    for (uint8_t ch = 1; ch <= 16; ch++) this->active_channels_.push_back(ch);
+    this->active_channels_.reserve(MAX_CHANNELS);
+    for (uint8_t ch = 1; ch <= MAX_CHANNELS; ch++) this->active_channels_.push_back(ch);
   }
+  // Channels without an explicit refresh interval keep the old round-robin period
+  size_t cycles = (this->active_channels_.size() + this->poll_channels_per_cycle_ - 1) / this->poll_channels_per_cycle_;
+  uint32_t default_interval = (uint32_t) cycles * this->get_update_interval();
+  uint32_t now = millis();
+  for (auto ch : this->active_channels_) {
+    auto &interval = this->refresh_interval_ms_[ch];
+    if (interval == 0) interval = default_interval;
+    this->next_due_ms_[ch] = now + interval;
+  }
+  // Initial full read of every channel runs as discovery, ahead of the routine schedule
+  for (auto ch : this->active_channels_) this->enqueue_channel(ch, PRIO_DISCOVERY);
+  this->sweep_start_ms_ = now;
+#ifdef WAVIN_AHC9000_IO_TASK
+  if (this->io_task_enabled_) this->start_io_task();
+#endif
+}
+
+void WavinAHC9000::set_channel_refresh_interval(uint8_t ch, uint32_t ms) {
+  auto &interval = this->refresh_interval_ms_[ch];
+  if (interval == 0 || ms < interval) interval = ms;
 }
 
 void WavinAHC9000::loop() {
-  // Process the poll queue one step at a time to avoid blocking the main loop
-  if (this->poll_queue_.empty()) return;
+  uint32_t loop_start = micros();
+  // Entity fan-out is paced independently of bus work
+  this->flush_held_publishes();
+  this->drain_publish_queue();
+  this->run_bus_job();
+  this->check_fault_summary();
+  // Worst-case blocking is what a degraded bus costs the rest of the firmware
+  uint32_t loop_us = micros() - loop_start;
+  if (loop_us > this->sweep_.max_loop_us) this->sweep_.max_loop_us = loop_us;
+}
 
-  uint8_t ch_num = this->poll_queue_.front();
-  uint8_t ch_page = (uint8_t) (ch_num - 1);
-  uint8_t &step = this->channel_step_[ch_page];
+void WavinAHC9000::run_bus_job() {
+  // One bus job per loop() call to avoid blocking the main loop. The highest non-empty priority
+  // wins, so a waiting user command preempts routine polling at the next transaction boundary;
+  // a preempted channel keeps its step in channel_step_ and resumes where it left off.
+#ifdef WAVIN_AHC9000_IO_TASK
+  // With the I/O task a bus job is in flight across loop() calls; the bus is busy until it lands
+  if (this->io_job_.active && !this->io_poll_job()) return;
+  if (this->trace_dump_due_) {
+    this->trace_dump_due_ = false;
+    if (this->io_running_) {
+      this->io_post(IO_JOB_TRACE, BusRequest{IO_SNAPSHOT_TRACE, 0, 0, 0, 0});
+      return;
+    }
+    this->log_bus_trace();
+  }
+#endif
+  auto &writes = this->bus_queues_[PRIO_WRITE];
+  if (!writes.empty()) {
+    uint8_t ch_num = writes.front();
+    writes.pop_front();
+    this->apply_pending_writes(ch_num);
+    return;
+  }
+
+  for (uint8_t prio = PRIO_VERIFY; prio < PRIO_COUNT; prio++) {
+    // Controller identity check, ahead of discovery so a resync it triggers is queued first
+    if (prio == PRIO_DISCOVERY && this->identity_check_due_) {
+      this->check_controller_identity();
+      return;
+    }
+    auto &queue = this->bus_queues_[prio];
+    if (queue.empty()) continue;
 
-  // Execute one step of the state machine
-  // If the step logic returns true, it means the channel is done (step wrapped to 0)
-  // If false, we keep the channel at the front to process the next step in the next loop() call
-  if (this->process_channel_step(ch_num, step)) {
-    this->poll_queue_.pop_front();
+    uint8_t ch_num = queue.front();
+    uint8_t &step = this->channel_step_[ch_num - 1];
+    // Verification only needs the spans holding the fields still awaiting confirmation
+    uint8_t only = 0;
+    if (prio == PRIO_VERIFY && !this->full_read_due_[ch_num - 1]) {
+      auto want = this->desired_.find(ch_num);
+      if (want != this->desired_.end()) only = want->second.pending;
+    } else if (prio == PRIO_ROUTINE && this->element_only_[ch_num - 1]) {
+      only = ONLY_ELEMENT;
+    }
+    // Execute one step of the state machine
+    // If the step logic returns true, it means the channel is done (step wrapped to 0)
+    // If false, we keep the channel at the front to process the next step in the next loop() call
+    // Only routine polls probe; discovery, verification and explicit refreshes read everything.
+    bool probe = prio == PRIO_ROUTINE && this->probe_sweep_;
+#ifdef WAVIN_AHC9000_IO_TASK
+    if (this->io_running_) {
+      this->io_post_channel_step(ch_num, prio, only, probe);
+      return;
+    }
+#endif
+    if (this->process_channel_step(ch_num, step, only, probe)) this->finish_read_set(ch_num, prio, only);
+    return;
+  }
+  // Bus idle: background jobs
+  if (this->dump_.active) this->register_dump_step();
+}
+
+// Read set complete: publish the fresh state, verify pending writes and re-read right away
+// if corrections went out. Partial (verification) reads don't count as a refresh.
+void WavinAHC9000::finish_read_set(uint8_t ch_num, uint8_t prio, uint8_t only) {
+  auto &queue = this->bus_queues_[prio];
+  auto pos = std::find(queue.begin(), queue.end(), ch_num);
+  if (pos != queue.end()) queue.erase(pos);
+  this->element_only_[ch_num - 1] = false;
+  if (prio == PRIO_VERIFY) this->full_read_due_[ch_num - 1] = false;
+  auto &st = this->channels_[ch_num];
+  if (st.seq & 1) st.seq++;
+  this->state_seq_++;
+  // A failing read may be the controller going away; the identity check tells an outage from noise
+  if (!st.read_clean && this->identity_failures_ == 0) this->identity_check_due_ = true;
+  if (only == 0) {
+    if (st.read_clean) st.refreshed_ms = millis();
+    // A probe-only set refreshes no writable field
+    if (st.read_fields == (1 << FIELD_COUNT) - 1) {
+      this->sweep_.full_sets++;
+      if (st.read_clean) this->full_read_ms_[ch_num - 1] = millis();
+    } else if (st.read_fields == 0) {
+      this->sweep_.probe_sets++;
+    }
+#ifdef WAVIN_AHC9000_SENSOR
+    auto hist = this->histories_.find(ch_num);
+    if (hist != this->histories_.end()) {
+      if (!hist->second.is_initialized()) hist->second.init(this->history_samples_, this->history_window_ms_);
+      hist->second.add(millis(), st.current_temp_c, st.floor_temp_c, st.action == climate::CLIMATE_ACTION_HEATING);
+    }
+#endif
+    this->account_read_set();
+  }
+  this->update_shadow(ch_num);
+  this->notify_changes(ch_num);
+  this->queue_publish(ch_num);
+  if (this->reconcile_channel(ch_num)) this->enqueue_channel(ch_num, PRIO_VERIFY);
+}
+
+// Queue a channel at the given priority. A channel lives in at most one queue: entries at lower
+// priority are dropped and a pending higher-priority entry wins. A verification that displaces a
+// full read, or is asked to be one, reads every span so the displaced refresh is not lost.
+void WavinAHC9000::enqueue_channel(uint8_t ch, uint8_t prio, bool full) {
+  if (ch < 1 || ch > MAX_CHANNELS || prio >= PRIO_COUNT) return;
+  for (uint8_t p = 0; p < PRIO_COUNT; p++) {
+    auto &q = this->bus_queues_[p];
+    auto it = std::find(q.begin(), q.end(), ch);
+    if (it == q.end()) continue;
+    // Already queued at this or a higher priority; a verification in progress keeps its step,
+    // unless a partial one has to become full: the spans it skipped so far were never read
+    if (p <= prio && p != PRIO_WRITE) {
+      if (full && p == PRIO_VERIFY && !this->full_read_due_[ch - 1]) {
+        this->full_read_due_[ch - 1] = true;
+        this->channel_step_[ch - 1] = 0;
+      }
+      return;
+    }
+    if (p > prio) {
+      q.erase(it);
+      if (p != PRIO_VERIFY || this->full_read_due_[ch - 1]) full = true;
+    }
   }
+  // A write job is followed by its verification, which inherits a displaced full read
+  if (full && prio <= PRIO_VERIFY) this->full_read_due_[ch - 1] = true;
+  if (prio == PRIO_WRITE) {
+    auto &q = this->bus_queues_[PRIO_WRITE];
+    if (std::find(q.begin(), q.end(), ch) != q.end()) return;
+  }
+  if (prio == PRIO_VERIFY) this->channel_step_[ch - 1] = 0;  // a new verification starts a fresh read
+  this->bus_queues_[prio].push_back(ch);
 }
 
 void WavinAHC9000::set_channel_friendly_name(uint8_t channel, const std::string &name) {
-  if (channel < 1 || channel > 16) return;
-  if (this->channel_friendly_names_.size() < 17) this->channel_friendly_names_.assign(17, std::string());
+  if (channel < 1 || channel > MAX_CHANNELS) return;
+  if (this->channel_friendly_names_.size() <= MAX_CHANNELS) this->channel_friendly_names_.assign(MAX_CHANNELS + 1, std::string());
   this->channel_friendly_names_[channel] = name;
 }
 
 std::string WavinAHC9000::get_channel_friendly_name(uint8_t channel) const {
-  if (channel < 1 || channel > 16) return std::string();
-  if (this->channel_friendly_names_.size() < 17) return std::string();
+  if (channel < 1 || channel > MAX_CHANNELS) return std::string();
+  if (this->channel_friendly_names_.size() <= MAX_CHANNELS) return std::string();
   return this->channel_friendly_names_[channel];
 }
 
 void WavinAHC9000::update() {
-  // One-time query for device info (software version, etc.)
-  if (!this->device_info_read_) {
-    this->query_device_info();
-    this->device_info_read_ = true;
-  }
-
-  // 1. Schedule urgent channels (from writes) to the FRONT of the queue
-  for (auto ch : this->urgent_channels_) {
-    // Reset step to ensure full fresh read
-    if (ch >= 1 && ch <= 16) this->channel_step_[ch - 1] = 0;
-    this->poll_queue_.push_front(ch);
-  }
-  this->urgent_channels_.clear();
-
-  // 2. Schedule round-robin channels to the BACK of the queue
+  // Schedule due channels behind any pending higher-priority work. At most poll_channels_per_cycle
+  // per tick; when more are due, the ones furthest behind relative to their own interval go first.
   if (this->active_channels_.empty()) return;
 
-  for (uint8_t i = 0; i < this->poll_channels_per_cycle_; i++) {
-    if (this->next_active_index_ >= this->active_channels_.size()) this->next_active_index_ = 0;
-    uint8_t ch = this->active_channels_[this->next_active_index_];
-    
-    // Avoid duplicates in queue to prevent backlog
-    bool already_queued = false;
-    for (auto q_ch : this->poll_queue_) { if (q_ch == ch) { already_queued = true; break; } }
-    
-    if (!already_queued) {
-      this->poll_queue_.push_back(ch);
+  uint32_t now = millis();
+  // Identity check every identity_check_interval, and every tick while unanswered
+  if (!this->identity_.known || this->identity_failures_ > 0 ||
+      (this->identity_check_interval_ms_ != 0 && now - this->identity_checked_ms_ >= this->identity_check_interval_ms_))
+    this->identity_check_due_ = true;
+  std::vector<std::pair<float, uint8_t>> due;
+  for (uint8_t ch : this->active_channels_) {
+    int32_t late = (int32_t) (now - this->next_due_ms_[ch]);
+    if (late >= 0) due.emplace_back((float) late / this->refresh_interval_ms_[ch], ch);
+  }
+  size_t n = std::min<size_t>(due.size(), this->poll_channels_per_cycle_);
+  std::partial_sort(due.begin(), due.begin() + n, due.end(),
+                    [](const std::pair<float, uint8_t> &a, const std::pair<float, uint8_t> &b) { return a.first > b.first; });
+  for (size_t i = 0; i < n; i++) {
+    uint8_t ch = due[i].second;
+    // enqueue_channel() skips channels already queued to prevent backlog; a queued element-only
+    // read becomes a full one
+    this->element_only_[ch - 1] = false;
+    this->enqueue_channel(ch, PRIO_ROUTINE);
+    // Keep the phase, but drop slots missed while the bus was saturated instead of bursting
+    uint32_t &next = this->next_due_ms_[ch];
+    next += this->refresh_interval_ms_[ch];
+    if ((int32_t) (now - next) >= 0) next = now + this->refresh_interval_ms_[ch];
+  }
+  // Element-only reads just after each locked element's expected report
+  if (this->element_phase_polling_) {
+    for (uint8_t ch : this->active_channels_) {
+      const auto &e = this->element_sched_[ch - 1];
+      if (e.intervals < ELEMENT_LEARN_INTERVALS || e.misses > 0) continue;
+      uint32_t read_at = this->element_due_ms(ch, now);
+      if ((int32_t) (now - read_at) < 0 || (int32_t) (e.last_read_ms - read_at) >= 0) continue;
+      bool queued = false;
+      for (auto &q : this->bus_queues_) queued |= std::find(q.begin(), q.end(), ch) != q.end();
+      if (queued) continue;
+      this->element_only_[ch - 1] = true;
+      this->enqueue_channel(ch, PRIO_ROUTINE);
+      this->sweep_.element_reads++;
     }
-    
-    this->next_active_index_++;
   }
-
-  // publish once per cycle
-  this->publish_updates();
+  // Publishing happens per channel as each read set completes (see queue_publish())
 }
 
 // Helper to process one step of the state machine for a channel
 // Returns true if the channel cycle is complete (step wrapped to 0)
-bool WavinAHC9000::process_channel_step(uint8_t ch_num, uint8_t &step) {
+// Register reads and decoding come from the compile-time read plans in wavin_ahc9000.h.
+// With `only` set, steps whose plans hold none of those WavinField bits are skipped without bus traffic.
+// With `probe` set, an unchanged status step skips straight to the element block (see set_probe_sweep()).
+bool WavinAHC9000::process_channel_step(uint8_t ch_num, uint8_t &step, uint8_t only, bool probe) {
   uint8_t ch_page = (uint8_t) (ch_num - 1);
   auto &st = this->channels_[ch_num];
-  std::vector<uint16_t> regs;
+
+  if (step == 0) {
+    st.read_fields = 0;
+    st.read_clean = true;
+    if ((st.seq & 1) == 0) st.seq++;  // odd while the read set is in progress
+  }
+  if (only != 0) {
+    while (step < STEP_COUNT && !(STEP_FIELDS[step] & only)) step++;
+    if (step >= STEP_COUNT) {
+      step = 0;
+      return true;
+    }
+  }
 
   switch (step) {
     case 0: {
-      if (this->read_registers(CAT_CHANNELS, ch_page, CH_PRIMARY_ELEMENT, 1, regs) && regs.size() >= 1) {
-        uint16_t v = regs[0];
-        st.primary_index = v & CH_PRIMARY_ELEMENT_ELEMENT_MASK;
-        st.all_tp_lost = (v & CH_PRIMARY_ELEMENT_ALL_TP_LOST_MASK) != 0;
-        ESP_LOGD(TAG, "CH%u primary elem=%u lost=%s", ch_num, (unsigned) st.primary_index, st.all_tp_lost ? "Y" : "N");
+      uint16_t prev_status = st.raw_status;
+      uint16_t prev_primary = st.primary_index;
+      bool prev_lost = st.all_tp_lost;
+      step = 1;
+      if (this->read_plan(ChannelStatusPlan{}, ch_page, st) == ChannelStatusPlan::TRANSACTIONS) {
+        st.step_ms[0] = millis();
+        BUS_LOGD("CH%u status=0x%04X primary elem=%u lost=%s", ch_num, (unsigned) st.raw_status,
+                 (unsigned) st.primary_index, st.all_tp_lost ? "Y" : "N");
+        // Probe: with the status word (output bit aside, it is decoded here anyway) and the element
+        // assignment unchanged since a recent enough full read, configuration, setpoints and limits are
+        // taken as unchanged; go straight to the element block
+        uint32_t last_full = this->full_read_ms_[ch_num - 1];
+        if (probe && last_full != 0 && millis() - last_full < this->full_read_interval_ms_ &&
+            ((st.raw_status ^ prev_status) & ~CH_TIMER_EVENT_OUTP_ON_MASK) == 0 && st.primary_index == prev_primary &&
+            st.all_tp_lost == prev_lost) {
+          step = 4;
+        }
       } else {
-        ESP_LOGW(TAG, "CH%u: primary element read failed", ch_num);
+        st.read_clean = false;
+        BUS_LOGD("CH%u: status read failed", ch_num);
       }
-      step = 1;
       break;
     }
     case 1: {
-      if (this->read_registers(CAT_PACKED, ch_page, PACKED_CONFIGURATION, 1, regs) && regs.size() >= 1) {
-        uint16_t raw_cfg = regs[0];
-        uint16_t mode_bits = raw_cfg & PACKED_CONFIGURATION_MODE_MASK;
-        bool is_off = (mode_bits == PACKED_CONFIGURATION_MODE_STANDBY) || (mode_bits == PACKED_CONFIGURATION_MODE_STANDBY_ALT);
-        st.mode = is_off ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
-        st.child_lock = (raw_cfg & PACKED_CONFIGURATION_CHILD_LOCK_MASK) != 0;
-        ESP_LOGD(TAG, "CH%u cfg=0x%04X mode=%s child_lock=%s", ch_num, (unsigned) raw_cfg, is_off ? "OFF" : "HEAT", st.child_lock?"Y":"N");
-        
-        // Reconcile desired mode if pending and mismatch (moved from urgent block)
-        auto it_des = this->desired_mode_.find(ch_num);
-        if (it_des != this->desired_mode_.end()) {
-          auto want = it_des->second;
-          if (want != st.mode) {
-            uint16_t current = raw_cfg;
-            uint16_t new_bits = (want == climate::CLIMATE_MODE_OFF) ? PACKED_CONFIGURATION_MODE_STANDBY : PACKED_CONFIGURATION_MODE_MANUAL;
-            uint16_t next = (uint16_t) ((current & ~PACKED_CONFIGURATION_MODE_MASK) | (new_bits & PACKED_CONFIGURATION_MODE_MASK));
-            ESP_LOGW(TAG, "Reconciling mode for ch=%u cur=0x%04X next=0x%04X", (unsigned) ch_num, (unsigned) current, (unsigned) next);
-            if (this->write_register(CAT_PACKED, ch_page, PACKED_CONFIGURATION, next)) {
-              // Schedule immediate re-check by pushing to front of queue
-              this->poll_queue_.push_front(ch_num);
-              step = 0; // Restart scan for this channel
-              return false; // Not done
-            }
-          } else {
-            this->desired_mode_.erase(it_des);
-          }
-        }
+      if (this->read_plan(ConfigurationPlan{}, ch_page, st) == ConfigurationPlan::TRANSACTIONS) {
+        st.step_ms[1] = millis();
+        BUS_LOGD("CH%u cfg=0x%04X mode=%s child_lock=%s", ch_num, (unsigned) st.raw_config,
+                 st.mode == climate::CLIMATE_MODE_OFF ? "OFF" : "HEAT", st.child_lock ? "Y" : "N");
       } else {
-        ESP_LOGW(TAG, "CH%u: mode read failed", ch_num);
+        st.read_clean = false;
+        BUS_LOGD("CH%u: mode read failed", ch_num);
       }
       step = 2;
       break;
     }
     case 2: {
-      if (this->read_registers(CAT_PACKED, ch_page, PACKED_MANUAL_TEMPERATURE, 1, regs) && regs.size() >= 1) {
-        st.setpoint_c = this->raw_to_c(regs[0]);
-        ESP_LOGD(TAG, "CH%u setpoint=%.1fC", ch_num, st.setpoint_c);
-        if (this->read_registers(CAT_PACKED, ch_page, PACKED_STANDBY_TEMPERATURE, 1, regs) && regs.size() >= 1) {
-          st.standby_setpoint_c = this->raw_to_c(regs[0]);
-        }
-        if (this->read_registers(CAT_PACKED, ch_page, PACKED_HYSTERESIS, 1, regs) && regs.size() >= 1) {
-          st.hysteresis_c = (float) regs[0] / 10.0f;
-        }
+      if (this->read_plan(SetpointPlan{}, ch_page, st) == SetpointPlan::TRANSACTIONS) {
+        st.step_ms[2] = millis();
+        BUS_LOGD("CH%u setpoint=%.1fC", ch_num, st.setpoint_c);
       } else {
-        ESP_LOGW(TAG, "CH%u: setpoint read failed", ch_num);
+        st.read_clean = false;
+        BUS_LOGD("CH%u: setpoint read failed", ch_num);
       }
       step = 3;
       break;
     }
     case 3: {
-      if (this->read_registers(CAT_PACKED, ch_page, PACKED_FLOOR_MIN_TEMPERATURE, 2, regs) && regs.size() >= 2) {
-        st.floor_min_c = this->raw_to_c(regs[0]);
-        st.floor_max_c = this->raw_to_c(regs[1]);
-      }
-      if (this->read_registers(CAT_CHANNELS, ch_page, CH_TIMER_EVENT, 1, regs) && regs.size() >= 1) {
-        bool heating = (regs[0] & CH_TIMER_EVENT_OUTP_ON_MASK) != 0;
-        st.action = heating ? climate::CLIMATE_ACTION_HEATING : climate::CLIMATE_ACTION_IDLE;
-        ESP_LOGD(TAG, "CH%u action=%s", ch_num, heating ? "HEATING" : "IDLE");
+      if (this->read_plan(FloorLimitsPlan{}, ch_page, st) == FloorLimitsPlan::TRANSACTIONS) {
+        st.step_ms[3] = millis();
+        BUS_LOGD("CH%u floor limits=%.1f..%.1fC", ch_num, st.floor_min_c, st.floor_max_c);
       } else {
-        ESP_LOGW(TAG, "CH%u: action read failed", ch_num);
+        st.read_clean = false;
+        BUS_LOGD("CH%u: floor limit read failed", ch_num);
       }
       step = 4;
       break;
     }
     case 4: {
-      if (!st.all_tp_lost && st.primary_index > 0) {
+      if (st.all_tp_lost || st.primary_index == 0) {
+        st.current_temp_c = NAN;
+        // Lost element: its schedule is relearned once it reports again
+        this->element_sched_[ch_num - 1] = ElementSchedule{};
+      } else if (this->element_read_due(ch_num, only)) {
         uint8_t elem_page = (uint8_t) (st.primary_index - 1);
-        if (this->read_registers(CAT_ELEMENTS, elem_page, 0x00, 11, regs) && regs.size() > ELEM_AIR_TEMPERATURE) {
-          st.current_temp_c = this->raw_to_c(regs[ELEM_AIR_TEMPERATURE]);
-          if (regs.size() > ELEM_FLOOR_TEMPERATURE) {
-            float ft = this->raw_to_c(regs[ELEM_FLOOR_TEMPERATURE]);
-            if (ft > 1.0f && ft < 90.0f) {
-              st.floor_temp_c = ft;
-              st.has_floor_sensor = true;
-            } else {
-              st.floor_temp_c = NAN;
-            }
-          }
-          ESP_LOGD(TAG, "CH%u current=%.1fC", ch_num, st.current_temp_c);
-          
-          // Publish sensors immediately
-          auto it_t = this->temperature_sensors_.find(ch_num);
-          if (it_t != this->temperature_sensors_.end() && it_t->second != nullptr && !std::isnan(st.current_temp_c)) {
-            it_t->second->publish_state(st.current_temp_c);
-          }
-          auto it_ft = this->floor_temperature_sensors_.find(ch_num);
-          if (it_ft != this->floor_temperature_sensors_.end() && it_ft->second != nullptr && !std::isnan(st.floor_temp_c)) {
-            it_ft->second->publish_state(st.floor_temp_c);
-          }
-          if (regs.size() > ELEM_BATTERY_STATUS) {
-            uint16_t raw = regs[ELEM_BATTERY_STATUS];
-            uint8_t steps = (raw > 10) ? 10 : (uint8_t) raw;
-            st.battery_pct = (uint8_t) (steps * 10);
-            auto it = this->battery_sensors_.find(ch_num);
-            if (it != this->battery_sensors_.end() && it->second != nullptr) {
-              it->second->publish_state((float) st.battery_pct);
-            }
-          }
-          if (this->read_registers(CAT_ELEMENTS, elem_page, ELEM_RSSI, 1, regs) && regs.size() >= 1) {
-            uint16_t rssi_reg = regs[0];
-            st.rssi_element_dbm = raw_rssi_to_dbm((rssi_reg >> 8) & 0xFF);
-            st.rssi_cu_dbm = raw_rssi_to_dbm(rssi_reg & 0xFF);
-            auto it_rssi_el = this->rssi_element_sensors_.find(ch_num);
-            if (it_rssi_el != this->rssi_element_sensors_.end() && it_rssi_el->second != nullptr) {
-              it_rssi_el->second->publish_state(st.rssi_element_dbm);
-            }
-            auto it_rssi_cu = this->rssi_cu_sensors_.find(ch_num);
-            if (it_rssi_cu != this->rssi_cu_sensors_.end() && it_rssi_cu->second != nullptr) {
-              it_rssi_cu->second->publish_state(st.rssi_cu_dbm);
-            }
-          }
+        float prev_air = st.current_temp_c, prev_floor = st.floor_temp_c;
+        float prev_rssi_elem = st.rssi_element_dbm, prev_rssi_cu = st.rssi_cu_dbm;
+        uint8_t prev_battery = st.battery_pct;
+        if (this->read_plan(ElementPlan{}, elem_page, st) == ElementPlan::TRANSACTIONS) {
+          st.step_ms[4] = millis();
+          BUS_LOGD("CH%u current=%.1fC", ch_num, st.current_temp_c);
+          // Every report refreshes the RSSI bytes, so an unchanged block almost always means no report
+          auto same = [](float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+          bool changed = !same(prev_air, st.current_temp_c) || !same(prev_floor, st.floor_temp_c) ||
+                         !same(prev_rssi_elem, st.rssi_element_dbm) || !same(prev_rssi_cu, st.rssi_cu_dbm) ||
+                         prev_battery != st.battery_pct;
+          if (this->element_phase_polling_) this->observe_element(ch_num, changed, st.step_ms[4]);
         } else {
-          ESP_LOGW(TAG, "CH%u: element temp read failed", ch_num);
+          st.read_clean = false;
+          BUS_LOGD("CH%u: element temp read failed", ch_num);
         }
       } else {
-        st.current_temp_c = NAN;
+        this->sweep_.element_skips++;
       }
       step = 0;
       break;
@@ -253,10 +403,180 @@ bool WavinAHC9000::process_channel_step(uint8_t ch_num, uint8_t &step) {
   return (step == 0);
 }
 
-void WavinAHC9000::dump_config() { ESP_LOGCONFIG(TAG, "Wavin AHC9000 Hub"); }
+// Element reporting model. A change in the element block means a report landed between the previous
+// read and this one. While reads are dense (learning, or after a missed report) the midpoint of the two
+// reads is taken as the report time; once locked, a change seen where the model expected one keeps the
+// predicted phase. Intervals between reports are folded into the period as multiples of the current
+// estimate, so reports that happened to carry identical values don't double it. A missed report sends
+// the channel back to reading every sweep until the element is found again, with a wider window after.
+void WavinAHC9000::observe_element(uint8_t ch_num, bool changed, uint32_t now) {
+  auto &e = this->element_sched_[ch_num - 1];
+  uint32_t prev_read = e.last_read_ms;
+  e.last_read_ms = now;
+  // The first read only sets the baseline: a block that was never read always looks changed
+  if (prev_read == 0) return;
+  bool locked = e.intervals >= ELEMENT_LEARN_INTERVALS;
+  if (!changed) {
+    if (locked && (int32_t) (now - this->element_due_ms(ch_num, now)) >= 0) {
+      if (e.misses == 0 && e.widen < 3) e.widen++;
+      if (e.misses < UINT8_MAX) e.misses++;
+      if (now - e.last_change_ms > ELEMENT_RELEARN_PERIODS * e.period_ms) {
+        ESP_LOGD(TAG, "CH%u: element stopped reporting on schedule, relearning", ch_num);
+        e = ElementSchedule{};
+        e.last_read_ms = now;
+      }
+    }
+    return;
+  }
+  uint32_t at = prev_read != 0 ? prev_read + (now - prev_read) / 2 : now;
+  if (locked && e.misses == 0) {
+    uint32_t expected = this->element_due_ms(ch_num, now) - this->element_window_ms(ch_num);
+    if ((int32_t) (expected - prev_read) > 0 && (int32_t) (now - expected) >= 0) {
+      at = expected;
+      if (e.widen > 0) e.widen--;
+    }
+  }
+  if (e.last_change_ms != 0) {
+    uint32_t interval = at - e.last_change_ms;
+    if (e.period_ms == 0) {
+      if (interval >= ELEMENT_MIN_PERIOD_MS) e.period_ms = interval;
+    } else {
+      uint32_t k = std::max<uint32_t>(1, (interval + e.period_ms / 2) / e.period_ms);
+      int32_t err = (int32_t) (interval / k) - (int32_t) e.period_ms;
+      e.period_ms = std::max<uint32_t>(ELEMENT_MIN_PERIOD_MS, (uint32_t) ((int32_t) e.period_ms + err / 4));
+      if (e.intervals < UINT8_MAX) e.intervals++;
+      if (e.intervals == ELEMENT_LEARN_INTERVALS)
+        ESP_LOGD(TAG, "CH%u: element reports about every %us", ch_num, (unsigned) ((e.period_ms + 500) / 1000));
+    }
+  }
+  e.last_change_ms = at;
+  e.misses = 0;
+}
+
+// How long after an expected report the block is read: a tenth of the period, doubled for a weak
+// link and widened further after late reports
+uint32_t WavinAHC9000::element_window_ms(uint8_t ch_num) const {
+  const auto &e = this->element_sched_[ch_num - 1];
+  uint32_t window = std::max<uint32_t>(ELEMENT_MIN_WINDOW_MS, e.period_ms / 10);
+  auto it = this->channels_.find(ch_num);
+  if (it != this->channels_.end() && !(it->second.rssi_element_dbm >= ELEMENT_WEAK_RSSI_DBM)) window *= 2;
+  return window * (1 + e.widen);
+}
+
+// Read time for the latest report expected at or before now (its report time plus the window). The
+// report at last_change_ms has been seen, so until the next one is due this returns the next one's.
+uint32_t WavinAHC9000::element_due_ms(uint8_t ch_num, uint32_t now) const {
+  const auto &e = this->element_sched_[ch_num - 1];
+  uint32_t window = this->element_window_ms(ch_num);
+  uint32_t since = now - e.last_change_ms;
+  if (since < e.period_ms + window) return e.last_change_ms + e.period_ms + window;
+  return e.last_change_ms + ((since - window) / e.period_ms) * e.period_ms + window;
+}
+
+// Whether step 4 reads the element block. Element-only reads always do; a full read set skips it
+// while the learned schedule expects no report since the last read.
+bool WavinAHC9000::element_read_due(uint8_t ch_num, uint8_t only) {
+#ifdef WAVIN_AHC9000_IO_TASK
+  // Replaying a posted step: the decision was taken when its reads were posted
+  if (this->io_replaying_) return this->io_replay_count_ > 0;
+#endif
+  const auto &e = this->element_sched_[ch_num - 1];
+  if (!this->element_phase_polling_ || (only & ONLY_ELEMENT) || e.intervals < ELEMENT_LEARN_INTERVALS || e.misses > 0)
+    return true;
+  uint32_t now = millis();
+  uint32_t due = this->element_due_ms(ch_num, now);
+  return (int32_t) (now - due) >= 0 && (int32_t) (e.last_read_ms - due) < 0;
+}
+
+WavinAHC9000::DesiredState &WavinAHC9000::desire(uint8_t channel) {
+  auto &want = this->desired_[channel];
+  if (want.pending == 0) {
+    // New change set: a new command with its own retry budget and latency clock
+    want.attempts = 0;
+    want.since_ms = this->command_issued_ms_ != 0 ? this->command_issued_ms_ : millis();
+    want.command_id = this->next_command_id_++;
+    want.sent_ms = want.acked_ms = 0;
+  }
+  return want;
+}
+
+// Compare the read set that just completed against the desired state for this channel.
+// Confirmed fields are dropped; mismatches are queued as one write job (mode and child lock share
+// PACKED_CONFIGURATION, adjacent registers share a transaction, see write_batch()).
+// Returns true when the channel should just be re-read; a correction queues its own verification.
+bool WavinAHC9000::reconcile_channel(uint8_t ch_num) {
+  auto it = this->desired_.find(ch_num);
+  if (it == this->desired_.end()) return false;
+  auto &want = it->second;
+  auto &st = this->channels_[ch_num];
+
+  uint8_t seen = want.pending & st.read_fields;
+  uint8_t wrong = 0;
+  if ((seen & FIELD_SETPOINT) && this->c_to_raw(st.setpoint_c) != want.setpoint_raw) wrong |= FIELD_SETPOINT;
+  if ((seen & FIELD_STANDBY_SETPOINT) && this->c_to_raw(st.standby_setpoint_c) != want.standby_raw) wrong |= FIELD_STANDBY_SETPOINT;
+  if ((seen & FIELD_HYSTERESIS) && (uint16_t) std::round(st.hysteresis_c * 10.0f) != want.hysteresis_raw) wrong |= FIELD_HYSTERESIS;
+  if ((seen & FIELD_FLOOR_MIN) && this->c_to_raw(st.floor_min_c) != want.floor_min_raw) wrong |= FIELD_FLOOR_MIN;
+  if ((seen & FIELD_FLOOR_MAX) && this->c_to_raw(st.floor_max_c) != want.floor_max_raw) wrong |= FIELD_FLOOR_MAX;
+  if ((seen & FIELD_MODE) && st.mode != want.mode) wrong |= FIELD_MODE;
+  if ((seen & FIELD_CHILD_LOCK) && st.child_lock != want.child_lock) wrong |= FIELD_CHILD_LOCK;
+  want.pending &= (uint8_t) ~(seen & ~wrong);
 
+  if (want.pending == 0) {
+    ESP_LOGI(TAG, "CH%u: command #%u converged in %ums (%u correction pass%s)", ch_num, (unsigned) want.command_id,
+             (unsigned) (millis() - want.since_ms), (unsigned) want.attempts, want.attempts == 1 ? "" : "es");
+    // Elided commands never went out; they have no bus latency to report
+    if (want.sent_ms != 0) {
+      this->awaiting_publish_[ch_num] =
+          CommandTiming{want.command_id, want.since_ms, want.sent_ms, want.acked_ms, millis(), want.attempts};
+    }
+    this->desired_.erase(it);
+    this->scene_result(ch_num, true);
+    return false;
+  }
+  if (want.attempts >= RECONCILE_MAX_ATTEMPTS) {
+    ESP_LOGW(TAG, "CH%u: giving up reconciliation after %u passes (unconfirmed fields=0x%02X)", ch_num,
+             (unsigned) want.attempts, (unsigned) want.pending);
+    this->desired_.erase(it);
+    this->scene_result(ch_num, false);
+    return false;
+  }
+  want.attempts++;
+  if (wrong == 0) return true;  // only unverified fields left (read failed): just re-read
+
+  ESP_LOGW(TAG, "CH%u: reconciling fields=0x%02X (pass %u)", ch_num, (unsigned) wrong, (unsigned) want.attempts);
+  // The corrections go out as a regular write job, which queues the next verification itself
+  want.unsent |= wrong;
+  this->enqueue_channel(ch_num, PRIO_WRITE);
+  return false;
+}
+
+void WavinAHC9000::dump_config() {
+  ESP_LOGCONFIG(TAG, "Wavin AHC9000 Hub");
+  ESP_LOGCONFIG(TAG, "  Entity platforms: %s", ENTITY_PLATFORMS);
+  ESP_LOGCONFIG(TAG, "  Model channels: %u (%u active)", (unsigned) MAX_CHANNELS, (unsigned) this->active_channels_.size());
+  ESP_LOGCONFIG(TAG, "  Probe sweep: %s (full read every %us)", this->probe_sweep_ ? "YES" : "NO",
+                (unsigned) (this->full_read_interval_ms_ / 1000));
+  ESP_LOGCONFIG(TAG, "  Element phase polling: %s", this->element_phase_polling_ ? "YES" : "NO");
+  if (this->identity_check_interval_ms_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Identity check: every %us", (unsigned) (this->identity_check_interval_ms_ / 1000));
+  } else {
+    ESP_LOGCONFIG(TAG, "  Identity check: after failed reads only");
+  }
+#ifdef WAVIN_AHC9000_IO_TASK
+  ESP_LOGCONFIG(TAG, "  Bus I/O task: %s",
+                !this->io_task_enabled_ ? "NO" : (this->io_running_ ? "YES" : "NO (start failed, inline I/O)"));
+#endif
+#ifdef WAVIN_AHC9000_FAULT_INJECTION
+  ESP_LOGW(TAG, "  Fault injection ACTIVE: drop=%.4f flip=%.4f truncate=%.3f silence=%.3f latency=%ums echo=%s",
+           this->fault_.drop_rate, this->fault_.bit_flip_rate, this->fault_.truncate_rate, this->fault_.silence_rate,
+           (unsigned) this->fault_.latency_ms, this->fault_.tx_echo ? "Y" : "N");
+#endif
+}
+
+#ifdef WAVIN_AHC9000_SWITCH
 void WavinSwitch::write_state(bool state) {
   if (this->parent_ == nullptr) return;
+  this->parent_->begin_command();
   if (this->type_ == CHILD_LOCK) {
     this->parent_->write_channel_child_lock(this->channel_, state);
   } else if (this->type_ == STANDBY) {
@@ -265,14 +585,63 @@ void WavinSwitch::write_state(bool state) {
     auto mode = state ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
     this->parent_->write_channel_mode(this->channel_, mode);
   }
-  // Optimistic publish; hub publish_updates() will correct after refresh.
+  this->parent_->end_command();
+  // Optimistic publish; the hub republishes once the verification read completes.
   this->publish_state(state);
 }
+#endif
+
+void WavinAHC9000::add_channel_climate(WavinZoneClimate *c) {
+  this->single_ch_climates_.push_back(c);
+  uint16_t fields = CHANGE_TEMPERATURE | CHANGE_FLOOR_TEMPERATURE | CHANGE_SETPOINT | CHANGE_MODE | CHANGE_ACTION |
+                    CHANGE_FLOOR_MIN | CHANGE_FLOOR_MAX;
+  this->subscribe_channel(c->get_single_channel(), fields,
+                          [c](uint8_t ch, uint16_t changed) { c->on_channel_change(ch, changed); });
+}
+void WavinAHC9000::add_group_climate(WavinZoneClimate *c) {
+  this->group_climates_.push_back(c);
+  for (uint8_t member : c->get_members()) {
+    this->subscribe_channel(member, CHANGE_TEMPERATURE | CHANGE_SETPOINT | CHANGE_ACTION | CHANGE_MODE,
+                            [c](uint8_t ch, uint16_t changed) { c->on_channel_change(ch, changed); });
+  }
+}
 
-void WavinAHC9000::add_channel_climate(WavinZoneClimate *c) { this->single_ch_climates_.push_back(c); }
-void WavinAHC9000::add_group_climate(WavinZoneClimate *c) { this->group_climates_.push_back(c); }
+void WavinAHC9000::subscribe_channel(uint8_t channel, uint16_t fields, ChannelListener listener) {
+  this->subscriptions_.push_back(Subscription{channel, fields, std::move(listener)});
+}
+
+// Diff the channel against the last notified snapshot and call the listeners whose fields moved.
+// A channel without a snapshot (first read, or after forget_published()) reports every field.
+void WavinAHC9000::notify_changes(uint8_t ch) {
+  const auto &st = this->channels_[ch];
+  ChannelSnapshot now{st.current_temp_c, st.floor_temp_c,  st.setpoint_c, st.standby_setpoint_c, st.hysteresis_c,
+                      st.floor_min_c,    st.floor_max_c,   st.mode,       st.action,             st.child_lock};
+  uint16_t changed = CHANGE_ALL;
+  auto prev = this->notified_.find(ch);
+  if (prev != this->notified_.end()) {
+    const ChannelSnapshot &was = prev->second;
+    // NaN == NaN here: an absent value that stays absent is not a change
+    auto moved = [](float a, float b) { return std::isnan(a) ? !std::isnan(b) : (std::isnan(b) || a != b); };
+    changed = 0;
+    if (moved(now.current_c, was.current_c)) changed |= CHANGE_TEMPERATURE;
+    if (moved(now.floor_c, was.floor_c)) changed |= CHANGE_FLOOR_TEMPERATURE;
+    if (moved(now.setpoint_c, was.setpoint_c)) changed |= CHANGE_SETPOINT;
+    if (moved(now.standby_c, was.standby_c)) changed |= CHANGE_STANDBY_SETPOINT;
+    if (moved(now.hysteresis_c, was.hysteresis_c)) changed |= CHANGE_HYSTERESIS;
+    if (moved(now.floor_min_c, was.floor_min_c)) changed |= CHANGE_FLOOR_MIN;
+    if (moved(now.floor_max_c, was.floor_max_c)) changed |= CHANGE_FLOOR_MAX;
+    if (now.mode != was.mode) changed |= CHANGE_MODE;
+    if (now.action != was.action) changed |= CHANGE_ACTION;
+    if (now.child_lock != was.child_lock) changed |= CHANGE_CHILD_LOCK;
+    if (changed == 0) return;
+  }
+  this->notified_[ch] = now;
+  for (auto &sub : this->subscriptions_) {
+    if (sub.channel == ch && (sub.fields & changed)) sub.listener(ch, changed);
+  }
+}
 void WavinAHC9000::add_active_channel(uint8_t ch) {
-  if (ch < 1 || ch > 16) return;
+  if (ch < 1 || ch > MAX_CHANNELS) return;
   if (std::find(this->active_channels_.begin(), this->active_channels_.end(), ch) == this->active_channels_.end()) {
     this->active_channels_.push_back(ch);
   }
@@ -280,160 +649,545 @@ void WavinAHC9000::add_active_channel(uint8_t ch) {
 
 // Repair functions removed; use normalize_channel_config via API service
 
-bool WavinAHC9000::read_registers(uint8_t category, uint8_t page, uint8_t index, uint8_t count, std::vector<uint16_t> &out) {
-  // Retry logic: attempt up to IO_RETRY_ATTEMPTS. First attempt failures are logged at DEBUG; only the
-  // final failed attempt escalates to WARN to reduce log noise from transient bus glitches.
-  for (uint8_t attempt = 0; attempt < IO_RETRY_ATTEMPTS; attempt++) {
-    uint8_t msg[8];
-    msg[0] = DEVICE_ADDR;
-    msg[1] = FC_READ;
-    msg[2] = category;
-    msg[3] = index;
-    msg[4] = page;
-    msg[5] = count;
-    uint16_t crc = crc16(msg, 6);
-    msg[6] = crc & 0xFF;
-    msg[7] = crc >> 8;
+// Appends the CRC and transmits a request frame (len includes the two CRC bytes)
+void WavinAHC9000::send_frame(uint8_t *msg, size_t len) {
+  uint16_t crc = crc16(msg, len - 2);
+  msg[len - 2] = (uint8_t) (crc & 0xFF);
+  msg[len - 1] = (uint8_t) (crc >> 8);
 
   // Direction control: if a dedicated flow control pin (DE/RE) is provided, drive HIGH to enable TX.
   if (this->flow_control_pin_ != nullptr) this->flow_control_pin_->digital_write(true);
   if (this->tx_enable_pin_ != nullptr) this->tx_enable_pin_->digital_write(true);
-    ESP_LOGD(TAG, "TX: addr=0x%02X fc=0x%02X cat=%u idx=%u page=%u cnt=%u attempt=%u", msg[0], msg[1], category, index, page, count, (unsigned) attempt + 1);
-    this->write_array(msg, 8);
-    this->flush();
+  this->bus_trace_.record(BusTrace::DIR_TX, msg, len);
+  this->io_stats_->transactions++;
+  this->io_stats_->tx_bytes += len;
+  this->tx_start_us_ = micros();
+#ifdef WAVIN_AHC9000_FAULT_INJECTION
+  // A new request starts a new response: re-roll the per-frame faults
+  this->fault_echo_.assign(msg, msg + (this->fault_.tx_echo ? len : 0));
+  this->fault_echo_pos_ = 0;
+  this->fault_rx_count_ = 0;
+  this->fault_silent_ = this->fault_roll(this->fault_.silence_rate);
+  this->fault_truncate_at_ = this->fault_roll(this->fault_.truncate_rate) ? 1 + random_uint32() % 8 : SIZE_MAX;
+#endif
+  this->write_array(msg, len);
+  this->flush();
   // Allow line to settle; at 9600 baud 250us is < one char time but sufficient for DE switching.
   delayMicroseconds(250);
   if (this->tx_enable_pin_ != nullptr) this->tx_enable_pin_->digital_write(false);
   if (this->flow_control_pin_ != nullptr) this->flow_control_pin_->digital_write(false); // back to RX ASAP
+}
 
-    uint8_t buf[260];
-    size_t buf_len = 0;
-    uint32_t start = millis();
-    while (millis() - start < this->receive_timeout_ms_) {
-      while (this->available()) {
-        int c = this->read();
-        if (c < 0) break;
-        // Sync: only start buffering if we see our address at pos 0
-        if (buf_len == 0) {
-          if ((uint8_t)c == DEVICE_ADDR) buf[buf_len++] = (uint8_t)c;
-        } else {
-          if (buf_len < sizeof(buf)) buf[buf_len++] = (uint8_t)c;
-        }
-
-        if (buf_len >= 5) {
-          // Basic sanity check on length byte (index 2) to avoid huge allocations
-          if (buf[2] > 250) { buf_len = 0; continue; }
-          uint8_t expected = (uint8_t) (buf[2] + 5);
-          if (buf[0] == DEVICE_ADDR && buf[1] == FC_READ && buf_len == expected) {
-            uint16_t rcrc = crc16(buf, buf_len);
-            if (rcrc != 0) {
-              // CRC mismatch: retry unless last attempt
-              if (attempt + 1 == IO_RETRY_ATTEMPTS) {
-                ESP_LOGW(TAG, "RX: CRC mismatch (len=%u) after %u attempts", (unsigned) buf_len, (unsigned) IO_RETRY_ATTEMPTS);
-              } else {
-                ESP_LOGD(TAG, "RX: CRC mismatch attempt %u (len=%u) -> retry", (unsigned) attempt + 1, (unsigned) buf_len);
-              }
-              goto next_attempt; // break both loops, retry
-            }
-            uint8_t bytes = buf[2];
-            out.clear();
-            for (uint8_t i = 0; i + 1 < bytes; i += 2) {
-              uint16_t w = (uint16_t) (buf[3 + i] << 8) | buf[3 + i + 1];
-              out.push_back(w);
-            }
-            return true;
-          }
-        }
-        if (buf_len > 255) buf_len = 0; // Safety cap
+// Waits for the response to a request with the given function code. Bytes are synchronised on
+// DEVICE_ADDR and fed into a streaming CRC as they arrive.
+WavinAHC9000::RxResult WavinAHC9000::receive_frame(uint8_t function, uint8_t *buf, size_t &buf_len) {
+  buf_len = 0;
+  Crc16Stream crc;
+  uint32_t start = millis();
+  while (millis() - start < this->receive_timeout_ms_) {
+    for (int c; (c = this->read_rx_byte()) >= 0;) {
+      uint8_t b = (uint8_t) c;
+      // Sync: only start buffering if we see our address at pos 0
+      if (buf_len == 0) {
+        if (b != DEVICE_ADDR) continue;
+        crc.reset();
+      }
+      if (buf_len >= RX_BUFFER_SIZE) { buf_len = 0; continue; } // Safety cap
+      buf[buf_len++] = b;
+      crc.update(b);
+      // Basic sanity check on length byte (index 2) to avoid runaway frames
+      if (buf_len >= 3 && buf[2] > 250) { buf_len = 0; continue; }
+      if (buf_len >= 5 && buf[1] == function && buf_len == (size_t) buf[2] + 5) {
+        bool ok = crc.frame_ok();
+        this->bus_trace_.record(BusTrace::DIR_RX | (ok ? BusTrace::OUTCOME_OK : BusTrace::OUTCOME_CRC), buf, buf_len);
+        this->io_stats_->bus_us += micros() - this->tx_start_us_;
+        this->io_stats_->rx_bytes += buf_len;
+        if (!ok) this->io_stats_->crc_errors++;
+        return ok ? RX_OK : RX_CRC;
       }
+    }
+#ifdef WAVIN_AHC9000_IO_TASK
+    // The I/O task is not the loop task and has no watchdog of its own to feed
+    if (!this->io_running_)
+#endif
       App.feed_wdt();
-      delay(1);
+    delay(1);
+  }
+  // Keep whatever partial frame arrived; it is usually the interesting part
+  this->bus_trace_.record(BusTrace::DIR_RX | BusTrace::OUTCOME_TIMEOUT, buf, buf_len);
+  this->io_stats_->bus_us += micros() - this->tx_start_us_;
+  this->io_stats_->rx_bytes += buf_len;
+  this->io_stats_->timeouts++;
+  return RX_TIMEOUT;
+}
+
+// Byte source of receive_frame(). With WAVIN_AHC9000_FAULT_INJECTION the UART bytes pass through the
+// configured FaultProfile first: the echoed request, added latency, silenced or truncated responses,
+// dropped bytes and bit flips. The host fault shim (tests/support) is the repeatable way to measure
+// these; this path exists for soak tests on real hardware.
+int WavinAHC9000::read_rx_byte() {
+#ifdef WAVIN_AHC9000_FAULT_INJECTION
+  if (this->fault_echo_pos_ < this->fault_echo_.size()) return this->fault_echo_[this->fault_echo_pos_++];
+  // Latency holds bytes in the UART buffer, so they still count against the receive timeout
+  if (micros() - this->tx_start_us_ < this->fault_.latency_ms * 1000u) return -1;
+  while (this->available()) {
+    int c = this->read();
+    if (c < 0) return -1;
+    // Silenced and truncated responses are drained so nothing leaks into the next exchange
+    if (this->fault_silent_ || this->fault_rx_count_ >= this->fault_truncate_at_) continue;
+    if (this->fault_roll(this->fault_.drop_rate)) continue;
+    this->fault_rx_count_++;
+    if (this->fault_roll(this->fault_.bit_flip_rate)) c ^= 1 << (random_uint32() % 8);
+    return c;
+  }
+  return -1;
+#else
+  if (!this->available()) return -1;
+  return this->read();
+#endif
+}
+
+#ifdef WAVIN_AHC9000_FAULT_INJECTION
+bool WavinAHC9000::fault_roll(float probability) const {
+  if (probability <= 0.0f) return false;
+  return random_float() < probability;
+}
+#endif
+
+// Closes the sweep once as many read sets completed as there are active channels. All bus traffic in
+// between (writes, verification, discovery) is charged to the sweep.
+void WavinAHC9000::account_read_set() {
+  if (++this->sweep_channels_done_ < this->active_channels_.size()) return;
+  uint32_t now = millis();
+  this->sweep_.wall_ms = now - this->sweep_start_ms_;
+  // Data age: how stale the worst channel is; channels never read cleanly count from boot
+  for (uint8_t ch : this->active_channels_) {
+    uint32_t age = now - this->channels_[ch].refreshed_ms;
+    if (age > this->sweep_.max_data_age_ms) this->sweep_.max_data_age_ms = age;
+  }
+  this->last_sweep_ = this->sweep_;
+  ESP_LOGD(TAG, "Sweep: %u channels, %u transactions (%u timeouts, %u CRC), %u/%u bytes TX/RX, bus %ums, wall %ums",
+           (unsigned) this->sweep_channels_done_, (unsigned) this->sweep_.transactions, (unsigned) this->sweep_.timeouts,
+           (unsigned) this->sweep_.crc_errors, (unsigned) this->sweep_.tx_bytes, (unsigned) this->sweep_.rx_bytes,
+           (unsigned) (this->sweep_.bus_us / 1000u), (unsigned) this->sweep_.wall_ms);
+  ESP_LOGD(TAG, "Sweep: max data age %ums, max loop() %uus, %u writes elided (%u total), %u full / %u probe reads",
+           (unsigned) this->sweep_.max_data_age_ms, (unsigned) this->sweep_.max_loop_us,
+           (unsigned) this->sweep_.writes_elided, (unsigned) this->writes_elided_, (unsigned) this->sweep_.full_sets,
+           (unsigned) this->sweep_.probe_sets);
+  if (this->element_phase_polling_)
+    ESP_LOGD(TAG, "Sweep: %u element reads skipped, %u scheduled after expected reports",
+             (unsigned) this->sweep_.element_skips, (unsigned) this->sweep_.element_reads);
+  this->sweep_ = SweepStats{};
+  this->sweep_start_ms_ = now;
+  this->sweep_channels_done_ = 0;
+}
+
+void WavinAHC9000::dump_bus_trace() {
+  if (!this->bus_trace_.enabled()) {
+    ESP_LOGW(TAG, "Bus trace disabled (bus_trace_size: 0)");
+    return;
+  }
+#ifdef WAVIN_AHC9000_IO_TASK
+  // The trace buffer is written by the I/O task: it takes a snapshot once the bus is free and the
+  // main loop logs that
+  if (this->io_running_) {
+    this->trace_dump_due_ = true;
+    return;
+  }
+#endif
+  this->log_bus_trace();
+}
+
+void WavinAHC9000::log_bus_trace() {
+  size_t n = this->bus_trace_.dump(TAG);
+  ESP_LOGI(TAG, "Bus trace: %u frame(s)", (unsigned) n);
+}
+
+void WavinAHC9000::start_register_dump() {
+  if (this->dump_.active) {
+    ESP_LOGW(TAG, "Register dump already running (area %u page %u)", (unsigned) this->dump_.area,
+             (unsigned) this->dump_.page);
+    return;
+  }
+  this->dump_ = RegisterDump{};
+  this->dump_.active = true;
+  this->dump_.limit = this->dump_.span = DUMP_AREAS[0].registers;
+  this->dump_.start_ms = millis();
+  ESP_LOGI(TAG, "Register dump started");
+}
+
+// One read per call, as wide as the remaining page allows. Each successful span is emitted as one
+// bounded line ("c<cat> p<page> i<index>: hex words"), so nothing accumulates in RAM.
+// Block sizes are not documented: a rejected span is halved until a single register fails, which
+// marks the end of the block for the rest of the area. Once known, a failing page is skipped whole
+// (e.g. unpaired element slots) instead of being probed again.
+void WavinAHC9000::register_dump_step() {
+  auto &job = this->dump_;
+  const DumpArea &area = DUMP_AREAS[job.area];
+  uint8_t count = std::min<uint8_t>(job.span, (uint8_t) (job.limit - job.index));
+#ifdef WAVIN_AHC9000_IO_TASK
+  if (this->io_running_ && !this->io_replaying_) {
+    this->io_post(IO_JOB_DUMP_STEP, BusRequest{FC_READ, area.category, job.page, job.index, count});
+    return;
+  }
+#endif
+  job.transactions++;
+  if (this->read_registers(area.category, job.page, job.index, count, this->dump_regs_) &&
+      this->dump_regs_.size() >= count) {
+    char line[16 + 5 * 32];
+    int pos = snprintf(line, sizeof(line), "c%u p%02u i%02X:", (unsigned) area.category, (unsigned) job.page,
+                       (unsigned) job.index);
+    for (uint8_t i = 0; i < count && pos < (int) sizeof(line) - 6; i++) {
+      pos += snprintf(line + pos, sizeof(line) - pos, " %04X", (unsigned) this->dump_regs_[i]);
     }
-    // Timeout
-    if (attempt + 1 == IO_RETRY_ATTEMPTS) {
-      ESP_LOGW(TAG, "RX: timeout waiting for response after %u attempts (cat=%u idx=%u page=%u cnt=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page, count);
+    ESP_LOGI(TAG, "DUMP %s", line);
+#ifdef WAVIN_AHC9000_TEXT_SENSOR
+    if (this->register_dump_sensor_ != nullptr) this->register_dump_sensor_->publish_state(line);
+#endif
+    job.registers += count;
+    job.index += count;
+  } else if (!job.limit_known && count > 1) {
+    job.span = count / 2;
+    return;
+  } else {
+    if (!job.limit_known && job.index > 0) {
+      job.limit = job.index;
+      job.limit_known = true;
+      ESP_LOGI(TAG, "Register dump: category %u block is %u registers", (unsigned) area.category,
+               (unsigned) job.limit);
     } else {
-      ESP_LOGD(TAG, "RX: timeout attempt %u (cat=%u idx=%u page=%u) -> retry", (unsigned) attempt + 1, category, index, page);
+      job.skipped++;
+      ESP_LOGD(TAG, "Register dump: c%u p%02u unreadable from i%02X", (unsigned) area.category, (unsigned) job.page,
+               (unsigned) job.index);
     }
-  next_attempt:;
+    job.index = job.limit;
+  }
+
+  if (job.index < job.limit) return;
+  // Page done: next page, then next area
+  job.index = 0;
+  job.span = job.limit;
+  if (++job.page < area.pages) return;
+  job.page = 0;
+  if (++job.area < DUMP_AREA_COUNT) {
+    job.limit = job.span = DUMP_AREAS[job.area].registers;
+    job.limit_known = false;
+    return;
+  }
+  job.active = false;
+  this->dump_regs_.clear();
+  this->dump_regs_.shrink_to_fit();
+  ESP_LOGI(TAG, "Register dump finished: %u registers in %u transactions, %u page(s) unreadable, took %ums",
+           (unsigned) job.registers, (unsigned) job.transactions, (unsigned) job.skipped,
+           (unsigned) (millis() - job.start_ms));
+}
+
+// --- BusTrace ---
+
+void BusTrace::append(uint8_t flags, const uint8_t *data, size_t len) {
+  size_t cap = this->buf_.size();
+  if (len > 255) len = 255;
+  if (HEADER + len > cap) len = cap > HEADER ? cap - HEADER : 0;
+  if (HEADER + len > cap) return;
+  size_t need = HEADER + len;
+  // Drop oldest records until the new one fits
+  while (cap - this->used_ < need) {
+    size_t rec = HEADER + this->at(0);
+    this->head_ = (this->head_ + rec) % cap;
+    this->used_ -= rec;
+  }
+  uint32_t t = micros();
+  size_t off = this->used_;
+  this->put(off++, (uint8_t) len);
+  this->put(off++, flags);
+  for (uint8_t i = 0; i < 4; i++) this->put(off++, (uint8_t) (t >> (8 * i)));
+  for (size_t i = 0; i < len; i++) this->put(off++, data[i]);
+  this->used_ += need;
+}
+
+size_t BusTrace::dump(const char *tag) const {
+  // One line per frame: +<us since first record> <TX|RX> <OK|TO|CRC> <hex>. Frames longer than
+  // BYTES_PER_LINE continue on further lines prefixed with their byte offset, so no line outgrows
+  // the logger buffer.
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  static const uint8_t BYTES_PER_LINE = 32;
+  char hex[2 * BYTES_PER_LINE + 1];
+  size_t off = 0, count = 0;
+  uint32_t t0 = 0;
+  while (off < this->used_) {
+    uint8_t len = this->at(off);
+    uint8_t flags = this->at(off + 1);
+    uint32_t t = 0;
+    for (uint8_t i = 0; i < 4; i++) t |= (uint32_t) this->at(off + 2 + i) << (8 * i);
+    if (count == 0) t0 = t;
+    const char *outcome = (flags & OUTCOME_TIMEOUT) ? "TO" : (flags & OUTCOME_CRC) ? "CRC" : "OK";
+    size_t pos = 0;
+    do {
+      size_t n = std::min<size_t>(BYTES_PER_LINE, len - pos);
+      for (size_t i = 0; i < n; i++) {
+        uint8_t b = this->at(off + HEADER + pos + i);
+        hex[2 * i] = HEX_DIGITS[b >> 4];
+        hex[2 * i + 1] = HEX_DIGITS[b & 0x0F];
+      }
+      hex[2 * n] = '\0';
+      if (pos == 0) {
+        ESP_LOGI(tag, "+%010u %s %s %s", (unsigned) (t - t0), (flags & DIR_RX) ? "RX" : "TX", outcome, hex);
+      } else {
+        ESP_LOGI(tag, "  ...%03u %s", (unsigned) pos, hex);
+      }
+      App.feed_wdt();
+      pos += n;
+    } while (pos < len);
+    off += HEADER + len;
+    count++;
+  }
+  return count;
+}
+
+static const char *category_name(uint8_t category) {
+  switch (category) {
+    case 0x01: return "CAT_ELEMENTS";
+    case 0x02: return "CAT_PACKED";
+    case 0x03: return "CAT_CHANNELS";
+    case 0x07: return "CAT_INFO";
+    default: return "CAT_?";
   }
+}
+
+// Final-attempt bus failures are rate limited: the first one in a window is logged in full (returns
+// true), the rest are only counted and reported by flush_fault_summary() when the window closes.
+bool WavinAHC9000::note_bus_fault(uint8_t kind, uint8_t category) {
+#ifdef WAVIN_AHC9000_IO_TASK
+  // Called on the I/O task: count the fault into the result, the main loop accounts and logs it
+  if (this->io_running_) {
+    uint8_t &count = this->io_task_faults_[kind][category & 0x07];
+    if (count < UINT8_MAX) count++;
+    return false;
+  }
+#endif
+  return this->count_bus_fault(kind, category);
+}
+
+bool WavinAHC9000::count_bus_fault(uint8_t kind, uint8_t category) {
+  if (!this->fault_window_open_) {
+    this->fault_window_open_ = true;
+    this->fault_window_start_ms_ = millis();
+    return true;
+  }
+  uint16_t &count = this->fault_counts_[kind][category & 0x07];
+  if (count < UINT16_MAX) count++;
   return false;
 }
 
+void WavinAHC9000::check_fault_summary() {
+  if (this->fault_window_open_ && millis() - this->fault_window_start_ms_ >= FAULT_SUMMARY_WINDOW_MS)
+    this->flush_fault_summary();
+}
+
+void WavinAHC9000::flush_fault_summary() {
+  static const char *const KIND_NAMES[BUS_FAULT_KIND_COUNT] = {"timeouts", "CRC errors"};
+  unsigned window_s = (unsigned) ((millis() - this->fault_window_start_ms_) / 1000u);
+  for (uint8_t kind = 0; kind < BUS_FAULT_KIND_COUNT; kind++) {
+    for (uint8_t cat = 0; cat < 8; cat++) {
+      uint16_t &count = this->fault_counts_[kind][cat];
+      if (count == 0) continue;
+      ESP_LOGW(TAG, "%u more %s on %s in the last %u s", (unsigned) count, KIND_NAMES[kind], category_name(cat), window_s);
+      count = 0;
+    }
+  }
+  this->fault_window_open_ = false;
+}
+
+bool WavinAHC9000::read_registers(uint8_t category, uint8_t page, uint8_t index, uint8_t count, std::vector<uint16_t> &out) {
+#ifdef WAVIN_AHC9000_IO_TASK
+  if (this->io_running_) {
+    // Every read was posted ahead (io_post()) and its result is replayed here, in posting order
+    if (this->io_replay_pos_ >= this->io_replay_count_) return false;
+    const BusResult &res = this->io_job_.results[this->io_replay_pos_++];
+    if (!res.ok) return false;
+    out.assign(res.regs, res.regs + res.count);
+    return true;
+  }
+#endif
+  return this->exec_read(category, page, index, count, out);
+}
+
 bool WavinAHC9000::write_register(uint8_t category, uint8_t page, uint8_t index, uint16_t value) {
-  // Similar retry strategy as read_registers() with severity gating.
+  return this->dispatch_write(category, page, index, &value, 1);
+}
+
+// Writes only run inside a write job (run_write_job()), on the thread that owns the bus
+bool WavinAHC9000::dispatch_write(uint8_t category, uint8_t page, uint8_t index, const uint16_t *values, uint8_t count) {
+  return this->exec_write(category, page, index, values, count);
+}
+
+bool WavinAHC9000::write_registers(uint8_t category, uint8_t page, uint8_t index, const uint16_t *values, uint8_t count) {
+  if (count == 0 || count > WRITE_MAX_REGS) return false;
+  auto write_singly = [&](uint8_t from) {
+    bool ok = true;
+    for (uint8_t i = from; i < count; i++) ok &= this->write_register(category, page, (uint8_t) (index + i), values[i]);
+    return ok;
+  };
+  if (count == 1 || this->multi_write_ == MULTI_WRITE_UNSUPPORTED) return write_singly(0);
+
+  // Support still unknown: note what the registers past the first hold now, so the read-back can
+  // tell a firmware that ignores them from one that clamps the values
+  bool probing = this->multi_write_ == MULTI_WRITE_UNKNOWN;
+  std::vector<uint16_t> before;
+  if (probing && (!this->exec_read(category, page, index, count, before) || before.size() < count)) before.clear();
+
+  if (!this->dispatch_write(category, page, index, values, count)) {
+    // Not acknowledged: as likely a bus fault as a refusal, so no conclusion; the next merged write
+    // probes again
+    return write_singly(0);
+  }
+  if (!probing) return true;
+
+  // First acknowledged multi-write: some firmwares acknowledge count > 1 but apply only the first
+  // register. Compare raw values: a clamped value still changed the register.
+  std::vector<uint16_t> back;
+  if (!this->exec_read(category, page, index, count, back) || back.size() < count) return true;  // ask again next time
+  bool exact = true, wanted = false, changed = false;
+  for (uint8_t i = 1; i < count; i++) {
+    exact &= back[i] == values[i];
+    if (before.empty()) continue;
+    wanted |= values[i] != before[i];
+    changed |= back[i] != before[i];
+  }
+  // The outcome is logged by finish_write_job() on the main loop
+  if (wanted && changed) {
+    this->multi_write_ = MULTI_WRITE_SUPPORTED;
+    return true;
+  }
+  if (wanted) {
+    this->multi_write_ = MULTI_WRITE_UNSUPPORTED;
+    return write_singly(1);
+  }
+  // Nothing to compare against (the values were already there, or the first read failed): stay
+  // unknown, and make sure the values land
+  return exact || write_singly(1);
+}
+
+// Sorts the batch by register and sends each run of adjacent registers as one transaction
+uint8_t WavinAHC9000::write_batch(uint8_t page, PendingWrite *writes, uint8_t count) {
+  std::sort(writes, writes + count, [](const PendingWrite &a, const PendingWrite &b) { return a.index < b.index; });
+  uint8_t acked = 0;
+  for (uint8_t start = 0; start < count;) {
+    uint8_t run = 1;
+    uint16_t values[WRITE_MAX_REGS] = {writes[start].value};
+    while (start + run < count && run < WRITE_MAX_REGS && writes[start + run].index == writes[start].index + run) {
+      values[run] = writes[start + run].value;
+      run++;
+    }
+    if (this->write_registers(CAT_PACKED, page, writes[start].index, values, run)) {
+      for (uint8_t i = start; i < start + run; i++) acked |= writes[i].fields;
+    }
+    start += run;
+  }
+  return acked;
+}
+
+bool WavinAHC9000::write_masked_register(uint8_t category, uint8_t page, uint8_t index, uint16_t and_mask, uint16_t or_mask) {
+  if (category == CAT_PACKED && page < MAX_CHANNELS) this->full_read_ms_[page] = 0;
+#ifdef WAVIN_AHC9000_IO_TASK
+  // The main loop does not wait for the bus while the I/O task owns it
+  if (this->io_running_) {
+    ESP_LOGW(TAG, "Masked write not available while the bus I/O task runs");
+    return false;
+  }
+#endif
+  return this->exec_write_masked(category, page, index, and_mask, or_mask);
+}
+
+bool WavinAHC9000::exec_read(uint8_t category, uint8_t page, uint8_t index, uint8_t count, std::vector<uint16_t> &out) {
+  // Retry logic: attempt up to IO_RETRY_ATTEMPTS. First attempt failures are traced at DEBUG; only the
+  // final failed attempt escalates to WARN (rate limited, see note_bus_fault()).
   for (uint8_t attempt = 0; attempt < IO_RETRY_ATTEMPTS; attempt++) {
-    uint8_t msg[10];
+    uint8_t msg[8];
     msg[0] = DEVICE_ADDR;
-    msg[1] = FC_WRITE;
+    msg[1] = FC_READ;
     msg[2] = category;
     msg[3] = index;
     msg[4] = page;
-    msg[5] = 1;  // count
-    msg[6] = (uint8_t) (value >> 8);
-    msg[7] = (uint8_t) (value & 0xFF);
-    uint16_t crc = crc16(msg, 8);
-    msg[8] = (uint8_t) (crc & 0xFF);
-    msg[9] = (uint8_t) (crc >> 8);
-
-  if (this->flow_control_pin_ != nullptr) this->flow_control_pin_->digital_write(true);
-  if (this->tx_enable_pin_ != nullptr) this->tx_enable_pin_->digital_write(true);
-    ESP_LOGD(TAG, "TX-WR: cat=%u idx=%u page=%u val=0x%04X attempt=%u", category, index, page, (unsigned) value, (unsigned) attempt + 1);
-    this->write_array(msg, 10);
-    this->flush();
-  delayMicroseconds(250);
-  if (this->tx_enable_pin_ != nullptr) this->tx_enable_pin_->digital_write(false);
-  if (this->flow_control_pin_ != nullptr) this->flow_control_pin_->digital_write(false);
+    msg[5] = count;
+    BUS_LOGD("TX: addr=0x%02X fc=0x%02X cat=%u idx=%u page=%u cnt=%u attempt=%u", msg[0], msg[1], category, index, page, count, (unsigned) attempt + 1);
+    this->send_frame(msg, sizeof(msg));
 
-    uint8_t buf[260];
+    uint8_t buf[RX_BUFFER_SIZE];
     size_t buf_len = 0;
-    uint32_t start = millis();
-    while (millis() - start < this->receive_timeout_ms_) {
-      while (this->available()) {
-        int c = this->read();
-        if (c < 0) break;
-        // Sync: only start buffering if we see our address at pos 0
-        if (buf_len == 0) {
-          if ((uint8_t)c == DEVICE_ADDR) buf[buf_len++] = (uint8_t)c;
-        } else {
-          if (buf_len < sizeof(buf)) buf[buf_len++] = (uint8_t)c;
-        }
-
-        if (buf_len >= 5) {
-          if (buf[2] > 250) { buf_len = 0; continue; }
-          uint8_t expected = (uint8_t) (buf[2] + 5);
-          if (buf[0] == DEVICE_ADDR && buf[1] == FC_WRITE && buf_len == expected) {
-            uint16_t rcrc = crc16(buf, buf_len);
-            bool ok = (rcrc == 0);
-            if (!ok) {
-              if (attempt + 1 == IO_RETRY_ATTEMPTS) {
-                ESP_LOGW(TAG, "ACK-WR: CRC mismatch after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
-              } else {
-                ESP_LOGD(TAG, "ACK-WR: CRC mismatch attempt %u -> retry", (unsigned) attempt + 1);
-              }
-              goto next_wr_attempt;
-            }
-            ESP_LOGD(TAG, "ACK-WR: OK");
-            return true;
-          }
-        }
-        if (buf_len > 255) buf_len = 0;
+    RxResult res = this->receive_frame(FC_READ, buf, buf_len);
+    if (res == RX_OK) {
+      uint8_t bytes = buf[2];
+      out.clear();
+      for (uint8_t i = 0; i + 1 < bytes; i += 2) {
+        uint16_t w = (uint16_t) (buf[3 + i] << 8) | buf[3 + i + 1];
+        out.push_back(w);
       }
-      App.feed_wdt();
-      delay(1);
+      return true;
     }
-    if (attempt + 1 == IO_RETRY_ATTEMPTS) {
-      ESP_LOGW(TAG, "ACK-WR: timeout after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
+    if (res == RX_CRC) {
+      // CRC mismatch: retry unless last attempt
+      if (attempt + 1 == IO_RETRY_ATTEMPTS) {
+        if (this->note_bus_fault(BUS_FAULT_CRC, category))
+          ESP_LOGW(TAG, "RX: CRC mismatch (len=%u) after %u attempts (cat=%u idx=%u page=%u)", (unsigned) buf_len,
+                   (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
+      } else {
+        BUS_LOGD("RX: CRC mismatch attempt %u (len=%u) -> retry", (unsigned) attempt + 1, (unsigned) buf_len);
+      }
+    } else if (attempt + 1 == IO_RETRY_ATTEMPTS) {
+      if (this->note_bus_fault(BUS_FAULT_TIMEOUT, category))
+        ESP_LOGW(TAG, "RX: timeout waiting for response after %u attempts (cat=%u idx=%u page=%u cnt=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page, count);
     } else {
-      ESP_LOGD(TAG, "ACK-WR: timeout attempt %u (cat=%u idx=%u page=%u) -> retry", (unsigned) attempt + 1, category, index, page);
+      BUS_LOGD("RX: timeout attempt %u (cat=%u idx=%u page=%u) -> retry", (unsigned) attempt + 1, category, index, page);
     }
-  next_wr_attempt:;
   }
   return false;
 }
 
-bool WavinAHC9000::write_masked_register(uint8_t category, uint8_t page, uint8_t index, uint16_t and_mask, uint16_t or_mask) {
-  // Similar retry strategy as write_register(); reduces spurious WARN logs.
+bool WavinAHC9000::exec_write(uint8_t category, uint8_t page, uint8_t index, const uint16_t *values, uint8_t count) {
+  // Similar retry strategy as exec_read() with severity gating.
+  for (uint8_t attempt = 0; attempt < IO_RETRY_ATTEMPTS; attempt++) {
+    uint8_t msg[8 + 2 * WRITE_MAX_REGS];
+    msg[0] = DEVICE_ADDR;
+    msg[1] = FC_WRITE;
+    msg[2] = category;
+    msg[3] = index;
+    msg[4] = page;
+    msg[5] = count;
+    for (uint8_t i = 0; i < count; i++) {
+      msg[6 + 2 * i] = (uint8_t) (values[i] >> 8);
+      msg[7 + 2 * i] = (uint8_t) (values[i] & 0xFF);
+    }
+    BUS_LOGD("TX-WR: cat=%u idx=%u page=%u cnt=%u val=0x%04X attempt=%u", category, index, page, count,
+             (unsigned) values[0], (unsigned) attempt + 1);
+    this->send_frame(msg, 8 + 2 * count);
+
+    uint8_t buf[RX_BUFFER_SIZE];
+    size_t buf_len = 0;
+    RxResult res = this->receive_frame(FC_WRITE, buf, buf_len);
+    if (res == RX_OK) {
+      BUS_LOGD("ACK-WR: OK");
+      return true;
+    }
+    if (res == RX_CRC) {
+      if (attempt + 1 == IO_RETRY_ATTEMPTS) {
+        if (this->note_bus_fault(BUS_FAULT_CRC, category))
+          ESP_LOGW(TAG, "ACK-WR: CRC mismatch after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
+      } else {
+        BUS_LOGD("ACK-WR: CRC mismatch attempt %u -> retry", (unsigned) attempt + 1);
+      }
+    } else if (attempt + 1 == IO_RETRY_ATTEMPTS) {
+      if (this->note_bus_fault(BUS_FAULT_TIMEOUT, category))
+        ESP_LOGW(TAG, "ACK-WR: timeout after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
+    } else {
+      BUS_LOGD("ACK-WR: timeout attempt %u (cat=%u idx=%u page=%u) -> retry", (unsigned) attempt + 1, category, index, page);
+    }
+  }
+  return false;
+}
+
+bool WavinAHC9000::exec_write_masked(uint8_t category, uint8_t page, uint8_t index, uint16_t and_mask, uint16_t or_mask) {
+  // Similar retry strategy as exec_write(); reduces spurious WARN logs.
   for (uint8_t attempt = 0; attempt < IO_RETRY_ATTEMPTS; attempt++) {
     uint8_t msg[12];
     msg[0] = DEVICE_ADDR;
@@ -446,234 +1200,772 @@ bool WavinAHC9000::write_masked_register(uint8_t category, uint8_t page, uint8_t
     msg[7] = (uint8_t) (and_mask & 0xFF);
     msg[8] = (uint8_t) (or_mask >> 8);
     msg[9] = (uint8_t) (or_mask & 0xFF);
-    uint16_t crc = crc16(msg, 10);
-    msg[10] = (uint8_t) (crc & 0xFF);
-    msg[11] = (uint8_t) (crc >> 8);
-
-  if (this->flow_control_pin_ != nullptr) this->flow_control_pin_->digital_write(true);
-  if (this->tx_enable_pin_ != nullptr) this->tx_enable_pin_->digital_write(true);
-    ESP_LOGD(TAG, "TX-WM: cat=%u idx=%u page=%u and=0x%04X or=0x%04X attempt=%u", category, index, page, (unsigned) and_mask, (unsigned) or_mask, (unsigned) attempt + 1);
-    this->write_array(msg, 12);
-    this->flush();
-  delayMicroseconds(250);
-  if (this->tx_enable_pin_ != nullptr) this->tx_enable_pin_->digital_write(false);
-  if (this->flow_control_pin_ != nullptr) this->flow_control_pin_->digital_write(false);
+    BUS_LOGD("TX-WM: cat=%u idx=%u page=%u and=0x%04X or=0x%04X attempt=%u", category, index, page, (unsigned) and_mask, (unsigned) or_mask, (unsigned) attempt + 1);
+    this->send_frame(msg, sizeof(msg));
 
-    uint8_t buf[260];
+    uint8_t buf[RX_BUFFER_SIZE];
     size_t buf_len = 0;
-    uint32_t start = millis();
-    while (millis() - start < this->receive_timeout_ms_) {
-      while (this->available()) {
-        int c = this->read();
-        if (c < 0) break;
-        // Sync: only start buffering if we see our address at pos 0
-        if (buf_len == 0) {
-          if ((uint8_t)c == DEVICE_ADDR) buf[buf_len++] = (uint8_t)c;
-        } else {
-          if (buf_len < sizeof(buf)) buf[buf_len++] = (uint8_t)c;
-        }
-
-        if (buf_len >= 5) {
-          if (buf[2] > 250) { buf_len = 0; continue; }
-          uint8_t expected = (uint8_t) (buf[2] + 5);
-          if (buf[0] == DEVICE_ADDR && buf[1] == FC_WRITE_MASKED && buf_len == expected) {
-            uint16_t rcrc = crc16(buf, buf_len);
-            bool ok = (rcrc == 0);
-            if (!ok) {
-              if (attempt + 1 == IO_RETRY_ATTEMPTS) {
-                ESP_LOGW(TAG, "ACK-WM: CRC mismatch after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
-              } else {
-                ESP_LOGD(TAG, "ACK-WM: CRC mismatch attempt %u -> retry", (unsigned) attempt + 1);
-              }
-              goto next_wm_attempt;
-            }
-            ESP_LOGD(TAG, "ACK-WM: OK");
-            return true;
-          }
-        }
-        if (buf_len > 255) buf_len = 0;
-      }
-      App.feed_wdt();
-      delay(1);
+    RxResult res = this->receive_frame(FC_WRITE_MASKED, buf, buf_len);
+    if (res == RX_OK) {
+      BUS_LOGD("ACK-WM: OK");
+      return true;
     }
-    if (attempt + 1 == IO_RETRY_ATTEMPTS) {
-      ESP_LOGW(TAG, "ACK-WM: timeout after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
+    if (res == RX_CRC) {
+      if (attempt + 1 == IO_RETRY_ATTEMPTS) {
+        if (this->note_bus_fault(BUS_FAULT_CRC, category))
+          ESP_LOGW(TAG, "ACK-WM: CRC mismatch after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
+      } else {
+        BUS_LOGD("ACK-WM: CRC mismatch attempt %u -> retry", (unsigned) attempt + 1);
+      }
+    } else if (attempt + 1 == IO_RETRY_ATTEMPTS) {
+      if (this->note_bus_fault(BUS_FAULT_TIMEOUT, category))
+        ESP_LOGW(TAG, "ACK-WM: timeout after %u attempts (cat=%u idx=%u page=%u)", (unsigned) IO_RETRY_ATTEMPTS, category, index, page);
     } else {
-      ESP_LOGD(TAG, "ACK-WM: timeout attempt %u (cat=%u idx=%u page=%u) -> retry", (unsigned) attempt + 1, category, index, page);
+      BUS_LOGD("ACK-WM: timeout attempt %u (cat=%u idx=%u page=%u) -> retry", (unsigned) attempt + 1, category, index, page);
     }
-  next_wm_attempt:;
   }
   return false;
 }
 
-void WavinAHC9000::query_device_info() {
-  if (this->software_version_sensor_ == nullptr && this->hardware_version_sensor_ == nullptr && this->device_name_sensor_ == nullptr) return;
+#ifdef WAVIN_AHC9000_IO_TASK
+// Hands the UART to a dedicated task. On dual-core ESP32 it is pinned to the core the loop task is
+// not running on; the host build runs the same loop on a std::thread. Falls back to inline I/O if
+// the task cannot be created.
+void WavinAHC9000::start_io_task() {
+  this->io_stats_ = &this->io_task_stats_;
+  this->io_regs_.reserve(IO_MAX_REGS);
+  this->io_stop_.store(false);
+  this->io_stopped_.store(false);
+  this->io_running_ = true;
+#ifdef USE_ESP32
+#if portNUM_PROCESSORS > 1
+  BaseType_t core = 1 - xPortGetCoreID();
+#else
+  BaseType_t core = 0;
+#endif
+  if (xTaskCreatePinnedToCore(io_task_entry, "wavin_io", 4096, this, 5, nullptr, core) != pdPASS) {
+    this->io_running_ = false;
+    this->io_stats_ = &this->sweep_;
+    ESP_LOGW(TAG, "I/O task could not be started; running bus I/O on the main loop");
+    return;
+  }
+  ESP_LOGCONFIG(TAG, "  Bus I/O task running on core %d", (int) core);
+#else
+  this->io_thread_ = std::thread(io_task_entry, this);
+  ESP_LOGCONFIG(TAG, "  Bus I/O thread running");
+#endif
+}
 
-  std::vector<uint16_t> regs;
-  // Read 3 registers: HW (0x02), SW (0x03), Name (0x04)
-  if (this->read_registers(CAT_INFO, 0, INFO_HW_VERSION, 3, regs) && regs.size() >= 3) {
-    if (this->hardware_version_sensor_ != nullptr) {
-      uint16_t raw = regs[0];
-      uint8_t suffix = raw & 0x7F;
-      this->hardware_version_sensor_->publish_state("MC110" + std::to_string(suffix));
-    }
-    if (this->software_version_sensor_ != nullptr) {
-      uint16_t raw = regs[1];
-      uint8_t bcd_suffix = (raw >> 4) & 0xFF; // Bits 11-4
-      uint8_t beta = raw & 0x0F;              // Bits 3-0
-      uint8_t suffix_dec = ((bcd_suffix >> 4) & 0x0F) * 10 + (bcd_suffix & 0x0F);
-      std::string sw = "MC610" + std::to_string(suffix_dec);
-      if (beta != 0) {
-        sw += "b" + std::to_string(beta);
-      }
-      this->software_version_sensor_->publish_state(sw);
+// Called from the main loop (on_shutdown, destructor). The task finishes the transaction it is in,
+// then exits. A job whose results are all back is completed; one that is not goes back to the
+// queues it came from and re-runs inline.
+void WavinAHC9000::stop_io_task() {
+  if (!this->io_running_) return;
+  this->io_stop_.store(true);
+#ifdef USE_ESP32
+  // A transaction in progress may still run every retry; a task stuck past that keeps the bus
+  uint32_t limit_ms = 2 * this->receive_timeout_ms_ * IO_RETRY_ATTEMPTS;
+  uint32_t start = millis();
+  while (!this->io_stopped_.load()) {
+    if (millis() - start > limit_ms) {
+      ESP_LOGW(TAG, "Bus I/O task did not stop within %ums; leaving it running", (unsigned) limit_ms);
+      return;
     }
-    if (this->device_name_sensor_ != nullptr) {
-      uint16_t raw = regs[2];
-      this->device_name_sensor_->publish_state("AC-" + std::to_string(raw));
+    delay(1);
+  }
+#else
+  if (this->io_thread_.joinable()) this->io_thread_.join();
+#endif
+  auto &job = this->io_job_;
+  if (job.active) this->io_poll_job();
+  if (job.active) {
+    // The task took requests strictly in order and ran each one it took, so the job never started
+    if (job.kind == IO_JOB_WRITE) {
+      const WriteJob &w = this->write_job_;
+      auto &want = this->desire(w.channel);
+      want.unsent |= w.todo;
+      for (uint8_t i = 0; w.config_exact && i < w.count; i++) {
+        if (w.writes[i].index != PACKED_CONFIGURATION) continue;
+        want.config_exact = true;
+        want.config_exact_raw = w.writes[i].value;
+      }
+      if (w.relearn_multi_write) this->multi_write_relearn_ = true;
+      this->enqueue_channel(w.channel, PRIO_WRITE);
+    } else if (job.kind == IO_JOB_IDENTITY) {
+      this->identity_check_due_ = true;
+    } else if (job.kind == IO_JOB_TRACE) {
+      this->trace_dump_due_ = true;
     }
+    // A channel step or register dump step was never advanced and runs again as it is
+    job.active = false;
+  }
+  BusRequest req;
+  BusResult res;
+  while (this->io_requests_.pop(req)) {
+  }
+  while (this->io_results_.pop(res)) {
+    this->sweep_.add_bus_counters(res.stats);
+    this->io_account_faults(res);
   }
+  this->sweep_.add_bus_counters(this->io_task_stats_);
+  this->io_task_stats_ = SweepStats{};
+  this->io_running_ = false;
+  this->io_stats_ = &this->sweep_;
+  ESP_LOGD(TAG, "Bus I/O task stopped");
 }
 
-// High-level write helpers
-void WavinAHC9000::write_channel_setpoint(uint8_t channel, float celsius) {
-  if (channel < 1 || channel > 16) return;
-  uint8_t page = (uint8_t) (channel - 1);
-  uint16_t raw = this->c_to_raw(celsius);
-  if (this->write_register(CAT_PACKED, page, PACKED_MANUAL_TEMPERATURE, raw)) {
-    this->channels_[channel].setpoint_c = celsius;
-  // Schedule a quick refresh on next cycle and briefly suspend normal polling to avoid collisions
-    this->urgent_channels_.push_back(channel);
-  }
+void WavinAHC9000::io_task_entry(void *arg) {
+  static_cast<WavinAHC9000 *>(arg)->io_task_loop();
+#ifdef USE_ESP32
+  vTaskDelete(nullptr);
+#endif
 }
 
-void WavinAHC9000::write_channel_standby_setpoint(uint8_t channel, float celsius) {
-  if (channel < 1 || channel > 16) return;
-  uint8_t page = (uint8_t) (channel - 1);
-  uint16_t raw = this->c_to_raw(celsius);
-  if (this->write_register(CAT_PACKED, page, PACKED_STANDBY_TEMPERATURE, raw)) {
-    this->channels_[channel].standby_setpoint_c = celsius;
-    // Schedule a quick refresh on next cycle
-    this->urgent_channels_.push_back(channel);
+// Owns the UART from here on: one request in, one result out, strictly in order, until stopped.
+// Nothing here logs or touches state the main loop reads before the result is back.
+void WavinAHC9000::io_task_loop() {
+  BusRequest req;
+  BusResult res;
+  while (!this->io_stop_.load()) {
+    if (!this->io_requests_.pop(req)) {
+      delay(1);
+      continue;
+    }
+    res.ok = false;
+    res.count = 0;
+    std::fill(&this->io_task_faults_[0][0], &this->io_task_faults_[0][0] + sizeof(this->io_task_faults_), 0);
+    switch (req.function) {
+      case FC_READ:
+        res.ok = this->exec_read(req.category, req.page, req.index, req.count, this->io_regs_);
+        if (res.ok) {
+          res.count = (uint8_t) std::min<size_t>(this->io_regs_.size(), IO_MAX_REGS);
+          std::copy(this->io_regs_.begin(), this->io_regs_.begin() + res.count, res.regs);
+        }
+        break;
+      case IO_WRITE_JOB:
+        this->run_write_job(this->write_job_);
+        res.ok = true;
+        break;
+      case IO_SNAPSHOT_TRACE:
+        this->trace_snapshot_ = this->bus_trace_;
+        res.ok = true;
+        break;
+    }
+    std::copy(&this->io_task_faults_[0][0], &this->io_task_faults_[0][0] + sizeof(this->io_task_faults_),
+              &res.faults[0][0]);
+    res.stats = this->io_task_stats_;
+    this->io_task_stats_ = SweepStats{};
+    while (!this->io_results_.push(res) && !this->io_stop_.load()) delay(1);
   }
+  this->io_stopped_.store(true);
 }
 
-void WavinAHC9000::write_group_setpoint(const std::vector<uint8_t> &members, float celsius) {
-  for (auto ch : members) this->write_channel_setpoint(ch, celsius);
+void WavinAHC9000::io_collect() {
+  auto &job = this->io_job_;
+  while (job.received < job.posted && this->io_results_.pop(job.results[job.received])) {
+    this->sweep_.add_bus_counters(job.results[job.received].stats);
+    this->io_account_faults(job.results[job.received]);
+    job.received++;
+  }
 }
 
-void WavinAHC9000::write_channel_mode(uint8_t channel, climate::ClimateMode mode) {
-  if (channel < 1 || channel > 16) return;
-  uint8_t page = (uint8_t) (channel - 1);
-  this->desired_mode_[channel] = mode;
-
-  // Try Read-Modify-Write first to preserve existing flags (Child Lock, Program, etc.)
-  bool ok = false;
-  std::vector<uint16_t> regs;
-  if (this->read_registers(CAT_PACKED, page, PACKED_CONFIGURATION, 1, regs) && regs.size() >= 1) {
-    uint16_t current = regs[0];
-    uint16_t new_bits = (mode == climate::CLIMATE_MODE_OFF) ? PACKED_CONFIGURATION_MODE_STANDBY : PACKED_CONFIGURATION_MODE_MANUAL;
-    // Clear Program/Schedule bits (0x0018) when manually changing mode to prevent controller revert
-    uint16_t mask = PACKED_CONFIGURATION_MODE_MASK | PACKED_CONFIGURATION_PROGRAM_MASK;
-    uint16_t next = (uint16_t) ((current & ~mask) | (new_bits & PACKED_CONFIGURATION_MODE_MASK));
-    if (next != current) {
-      ok = this->write_register(CAT_PACKED, page, PACKED_CONFIGURATION, next);
-      if (ok) {
-        ESP_LOGD(TAG, "Mode RMW ch=%u: 0x%04X -> 0x%04X", (unsigned) channel, (unsigned) current, (unsigned) next);
+// The task's per-transaction failure detail is gone by now; the first fault of a window gets a
+// short line, the rest go into the summary as usual
+void WavinAHC9000::io_account_faults(const BusResult &res) {
+  static const char *const KIND_NAMES[BUS_FAULT_KIND_COUNT] = {"timeout", "CRC mismatch"};
+  for (uint8_t kind = 0; kind < BUS_FAULT_KIND_COUNT; kind++) {
+    for (uint8_t cat = 0; cat < 8; cat++) {
+      for (uint8_t n = res.faults[kind][cat]; n > 0; n--) {
+        if (this->count_bus_fault(kind, cat))
+          ESP_LOGW(TAG, "Bus %s on %s after %u attempts", KIND_NAMES[kind], category_name(cat), (unsigned) IO_RETRY_ATTEMPTS);
       }
-    } else {
-      ok = true;
     }
   }
+}
+
+// Posts a single-request job; io_poll_job() completes it once the result is back
+void WavinAHC9000::io_post(uint8_t kind, const BusRequest &req) {
+  auto &job = this->io_job_;
+  job.active = true;
+  job.kind = kind;
+  job.received = 0;
+  job.posted = this->io_requests_.push(req) ? 1 : 0;
+}
 
-  // Fallback to strict baseline if read failed
-  if (!ok) {
-    uint16_t strict_val = (uint16_t) (0x4000 | (mode == climate::CLIMATE_MODE_OFF ? PACKED_CONFIGURATION_MODE_STANDBY : PACKED_CONFIGURATION_MODE_MANUAL));
-    // Attempt to preserve child lock from cache
-    if (this->channels_[channel].child_lock) {
-      strict_val |= PACKED_CONFIGURATION_CHILD_LOCK_MASK;
+// Posts the reads of the channel's current step; the step only advances once the results are back
+void WavinAHC9000::io_post_channel_step(uint8_t ch_num, uint8_t prio, uint8_t only, bool probe) {
+  auto &job = this->io_job_;
+  uint8_t step = this->channel_step_[ch_num - 1];
+  job.active = true;
+  job.kind = IO_JOB_CHANNEL_STEP;
+  job.ch = ch_num;
+  job.prio = prio;
+  job.only = only;
+  job.probe = probe;
+  job.step = step;
+  job.posted = job.received = 0;
+  // Same skipping as process_channel_step(), which repeats it when the results are replayed
+  if (only != 0) {
+    while (step < STEP_COUNT && !(STEP_FIELDS[step] & only)) step++;
+  }
+  uint8_t page = (uint8_t) (ch_num - 1);
+  const auto &st = this->channels_[ch_num];
+  switch (step) {
+    case 0: job.posted = this->io_post_plan(ChannelStatusPlan{}, page); break;
+    case 1: job.posted = this->io_post_plan(ConfigurationPlan{}, page); break;
+    case 2: job.posted = this->io_post_plan(SetpointPlan{}, page); break;
+    case 3: job.posted = this->io_post_plan(FloorLimitsPlan{}, page); break;
+    case 4:
+      if (!st.all_tp_lost && st.primary_index > 0 && this->element_read_due(ch_num, only))
+        job.posted = this->io_post_plan(ElementPlan{}, (uint8_t) (st.primary_index - 1));
+      break;
+    default: break;
+  }
+  this->io_poll_job();
+}
+
+// Returns true once the posted job has been completed (or dropped) and the bus is free again
+bool WavinAHC9000::io_poll_job() {
+  auto &job = this->io_job_;
+  this->io_collect();
+  if (job.received < job.posted) return false;
+  job.active = false;
+  switch (job.kind) {
+    case IO_JOB_WRITE:
+      this->finish_write_job(this->write_job_);
+      return true;
+    case IO_JOB_TRACE: {
+      size_t n = this->trace_snapshot_.dump(TAG);
+      ESP_LOGI(TAG, "Bus trace: %u frame(s)", (unsigned) n);
+      this->trace_snapshot_ = BusTrace();
+      return true;
+    }
+    case IO_JOB_CHANNEL_STEP: {
+      // Re-queued for verification while in flight: the step was reset and these results belong to no one
+      auto &queue = this->bus_queues_[job.prio];
+      if (queue.empty() || queue.front() != job.ch || this->channel_step_[job.ch - 1] != job.step) return true;
+      // A partial verification upgraded to a full read while in flight starts over
+      if (job.prio == PRIO_VERIFY && job.only != 0 && this->full_read_due_[job.ch - 1]) return true;
+      break;
     }
-    ESP_LOGW(TAG, "Mode RMW failed, using strict write ch=%u val=0x%04X", (unsigned) channel, (unsigned) strict_val);
-    ok = this->write_register(CAT_PACKED, page, PACKED_CONFIGURATION, strict_val);
+    default: break;
   }
-  if (ok) {
-    this->channels_[channel].mode = (mode == climate::CLIMATE_MODE_OFF) ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
-    this->urgent_channels_.push_back(channel);
-  } else {
-    ESP_LOGW(TAG, "Mode write failed for ch=%u", (unsigned) channel);
+  // Reads: the code that posted them runs again and takes the results in posting order
+  this->io_replay_pos_ = 0;
+  this->io_replay_count_ = job.posted;
+  this->io_replaying_ = true;
+  if (job.kind == IO_JOB_IDENTITY) {
+    this->check_controller_identity();
+  } else if (job.kind == IO_JOB_DUMP_STEP) {
+    this->register_dump_step();
+  } else if (this->process_channel_step(job.ch, this->channel_step_[job.ch - 1], job.only, job.probe)) {
+    this->finish_read_set(job.ch, job.prio, job.only);
   }
+  this->io_replaying_ = false;
+  this->io_replay_count_ = 0;
+  return true;
 }
+#endif
 
-void WavinAHC9000::write_channel_child_lock(uint8_t channel, bool enable) {
-  if (channel < 1 || channel > 16) return;
-  uint8_t page = (uint8_t) (channel - 1);
-  std::vector<uint16_t> regs;
-  if (!this->read_registers(CAT_PACKED, page, PACKED_CONFIGURATION, 1, regs) || regs.size() < 1) {
-    ESP_LOGW(TAG, "Child lock: read current config failed ch=%u", (unsigned) channel);
+void WavinAHC9000::check_controller_identity() {
+  this->identity_check_due_ = false;
+#ifdef WAVIN_AHC9000_IO_TASK
+  // Posted now, completed by running this again with the result once it is back
+  if (this->io_running_ && !this->io_replaying_) {
+    this->io_post(IO_JOB_IDENTITY, BusRequest{FC_READ, CAT_INFO, 0, INFO_HW_VERSION, 3});
     return;
   }
-  uint16_t current = regs[0];
-  uint16_t next;
-  if (enable)
-    next = (uint16_t) (current | PACKED_CONFIGURATION_CHILD_LOCK_MASK);
-  else
-    next = (uint16_t) (current & ~PACKED_CONFIGURATION_CHILD_LOCK_MASK);
-  if (next == current) {
-    ESP_LOGD(TAG, "Child lock: no change ch=%u (enable=%s)", (unsigned) channel, enable?"true":"false");
+#endif
+  std::vector<uint16_t> regs;
+  // Read 3 registers: HW (0x02), SW (0x03), Name (0x04)
+  if (!this->read_registers(CAT_INFO, 0, INFO_HW_VERSION, 3, regs) || regs.size() < 3) {
+    if (this->identity_failures_ < UINT8_MAX) this->identity_failures_++;
+    if (this->identity_failures_ == IDENTITY_OUTAGE_FAILURES && this->identity_.known)
+      ESP_LOGW(TAG, "Controller not answering; resyncing once it is back");
     return;
   }
-  if (this->write_register(CAT_PACKED, page, PACKED_CONFIGURATION, next)) {
-    this->channels_[channel].child_lock = enable;
-    this->urgent_channels_.push_back(channel);
-    ESP_LOGI(TAG, "Child lock: set ch=%u -> %s (0x%04X)", (unsigned) channel, enable?"ENABLED":"DISABLED", (unsigned) next);
-  } else {
-    ESP_LOGW(TAG, "Child lock: write failed ch=%u", (unsigned) channel);
+  this->identity_checked_ms_ = millis();
+  bool outage = this->identity_failures_ >= IDENTITY_OUTAGE_FAILURES;
+  this->identity_failures_ = 0;
+  ControllerIdentity id{regs[0], regs[1], regs[2], true};
+  const ControllerIdentity &was = this->identity_;
+  bool changed = was.known && (id.hw_version != was.hw_version || id.sw_version != was.sw_version ||
+                               id.device_name != was.device_name);
+  if (!was.known || changed) {
+    ESP_LOGI(TAG, "Controller identity: hw 0x%04X, sw 0x%04X, name AC-%u", (unsigned) id.hw_version,
+             (unsigned) id.sw_version, (unsigned) id.device_name);
+  }
+  bool first = !was.known;
+  this->identity_ = id;
+  if (first || changed) this->publish_device_info();
+  if (changed) {
+    // Possibly different firmware: the next write job learns multi-register write support again
+    this->multi_write_relearn_ = true;
+    this->resync_controller("Controller identity changed");
+  } else if (outage && !first) {
+    this->resync_controller("Controller answering again after an outage");
+  }
+}
+
+void WavinAHC9000::publish_device_info() {
+#ifdef WAVIN_AHC9000_TEXT_SENSOR
+  const ControllerIdentity &id = this->identity_;
+  if (this->hardware_version_sensor_ != nullptr) {
+    uint8_t suffix = id.hw_version & 0x7F;
+    this->hardware_version_sensor_->publish_state("MC110" + std::to_string(suffix));
+  }
+  if (this->software_version_sensor_ != nullptr) {
+    uint8_t bcd_suffix = (id.sw_version >> 4) & 0xFF; // Bits 11-4
+    uint8_t beta = id.sw_version & 0x0F;              // Bits 3-0
+    uint8_t suffix_dec = ((bcd_suffix >> 4) & 0x0F) * 10 + (bcd_suffix & 0x0F);
+    std::string sw = "MC610" + std::to_string(suffix_dec);
+    if (beta != 0) {
+      sw += "b" + std::to_string(beta);
+    }
+    this->software_version_sensor_->publish_state(sw);
+  }
+  if (this->device_name_sensor_ != nullptr) {
+    this->device_name_sensor_->publish_state("AC-" + std::to_string(id.device_name));
   }
+#endif
+}
+
+// After a reboot, a swap or an outage nothing read before can be trusted: the register shadow (write
+// elision), probe and element schedules and the publish memo are dropped, and every channel is read
+// again at discovery priority. Channels with commands awaiting confirmation go first. Cached values
+// stay visible until the fresh read replaces them.
+void WavinAHC9000::resync_controller(const char *reason) {
+  this->resyncs_++;
+  ESP_LOGW(TAG, "%s: dropping cached registers, resyncing %u channel(s)", reason,
+           (unsigned) this->active_channels_.size());
+  for (auto &kv : this->channels_) {
+    for (auto &sh : kv.second.shadow) sh.read_ms = 0;
+    this->forget_published(kv.first);
+  }
+  for (uint8_t i = 0; i < MAX_CHANNELS; i++) {
+    this->full_read_ms_[i] = 0;
+    this->element_sched_[i] = ElementSchedule{};
+  }
+  std::vector<uint8_t> order(this->active_channels_.begin(), this->active_channels_.end());
+  std::stable_partition(order.begin(), order.end(), [this](uint8_t ch) { return this->desired_.count(ch) != 0; });
+  for (uint8_t ch : order) {
+    // A read set in progress at routine priority restarts; writes and verification keep their place
+    auto &writes = this->bus_queues_[PRIO_WRITE];
+    auto &verify = this->bus_queues_[PRIO_VERIFY];
+    if (std::find(writes.begin(), writes.end(), ch) == writes.end() &&
+        std::find(verify.begin(), verify.end(), ch) == verify.end()) {
+      this->channel_step_[ch - 1] = 0;
+      this->element_only_[ch - 1] = false;
+    }
+    this->enqueue_channel(ch, PRIO_DISCOVERY);
+  }
+}
+
+// Refresh the register shadow from the fields the completed read set actually decoded
+void WavinAHC9000::update_shadow(uint8_t ch) {
+  auto &st = this->channels_[ch];
+  uint32_t now = millis();
+  auto take = [&](uint8_t field, uint16_t raw) {
+    auto &sh = st.shadow[__builtin_ctz(field)];
+    sh.raw = raw;
+    sh.read_ms = now;
+  };
+  uint8_t got = st.read_fields;
+  if (got & FIELD_SETPOINT) take(FIELD_SETPOINT, this->c_to_raw(st.setpoint_c));
+  if (got & FIELD_STANDBY_SETPOINT) take(FIELD_STANDBY_SETPOINT, this->c_to_raw(st.standby_setpoint_c));
+  // A mode write also clears Program/Schedule bits, so it is only a no-op when none are set
+  if (got & FIELD_MODE)
+    take(FIELD_MODE, (st.raw_config & PACKED_CONFIGURATION_PROGRAM_MASK) ? 0xFFFF : (st.mode == climate::CLIMATE_MODE_OFF ? 0 : 1));
+  if (got & FIELD_CHILD_LOCK) take(FIELD_CHILD_LOCK, st.child_lock ? 1 : 0);
+  if (got & FIELD_HYSTERESIS) take(FIELD_HYSTERESIS, (uint16_t) std::round(st.hysteresis_c * 10.0f));
+  if (got & FIELD_FLOOR_MIN) take(FIELD_FLOOR_MIN, this->c_to_raw(st.floor_min_c));
+  if (got & FIELD_FLOOR_MAX) take(FIELD_FLOOR_MAX, this->c_to_raw(st.floor_max_c));
+}
+
+// A write can be answered from cache when the controller was recently read holding exactly the
+// target value and no other value for the field is still in flight (that one must be overridden).
+bool WavinAHC9000::write_is_redundant(uint8_t channel, uint8_t field, uint16_t raw) {
+  if (this->write_elision_max_age_ms_ == 0) return false;
+  auto want = this->desired_.find(channel);
+  if (want != this->desired_.end() && (want->second.pending & field)) return false;
+  const auto &sh = this->channels_[channel].shadow[__builtin_ctz(field)];
+  if (sh.read_ms == 0 || sh.raw != raw || millis() - sh.read_ms > this->write_elision_max_age_ms_) return false;
+  this->writes_elided_++;
+  this->sweep_.writes_elided++;
+  ESP_LOGD(TAG, "CH%u: write of field 0x%02X elided (value read %ums ago)", channel, (unsigned) field,
+           (unsigned) (millis() - sh.read_ms));
+  return true;
+}
+
+// High-level write helpers: record the target and queue a write job. The bus work happens in loop()
+// at PRIO_WRITE, so a command preempts routine polling at the next transaction boundary and several
+// fields changed in one call (e.g. climate mode + setpoint) go out in the same job.
+void WavinAHC9000::write_channel_setpoint(uint8_t channel, float celsius) {
+  if (channel < 1 || channel > MAX_CHANNELS) return;
+  uint16_t raw = this->c_to_raw(celsius);
+  if (this->write_is_redundant(channel, FIELD_SETPOINT, raw)) return;
+  auto &want = this->desire(channel);
+  want.setpoint_raw = raw;
+  want.pending |= FIELD_SETPOINT;
+  want.unsent |= FIELD_SETPOINT;
+  this->enqueue_channel(channel, PRIO_WRITE);
+}
+
+void WavinAHC9000::write_channel_standby_setpoint(uint8_t channel, float celsius) {
+  if (channel < 1 || channel > MAX_CHANNELS) return;
+  uint16_t raw = this->c_to_raw(celsius);
+  if (this->write_is_redundant(channel, FIELD_STANDBY_SETPOINT, raw)) return;
+  auto &want = this->desire(channel);
+  want.standby_raw = raw;
+  want.pending |= FIELD_STANDBY_SETPOINT;
+  want.unsent |= FIELD_STANDBY_SETPOINT;
+  this->enqueue_channel(channel, PRIO_WRITE);
+}
+
+void WavinAHC9000::write_group_setpoint(const std::vector<uint8_t> &members, float celsius) {
+  for (auto ch : members) this->write_channel_setpoint(ch, celsius);
+}
+
+void WavinAHC9000::write_channel_mode(uint8_t channel, climate::ClimateMode mode) {
+  if (channel < 1 || channel > MAX_CHANNELS) return;
+  bool off = (mode == climate::CLIMATE_MODE_OFF);
+  if (this->write_is_redundant(channel, FIELD_MODE, off ? 0 : 1)) return;
+  auto &want = this->desire(channel);
+  want.mode = off ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
+  want.pending |= FIELD_MODE;
+  want.unsent |= FIELD_MODE;
+  this->enqueue_channel(channel, PRIO_WRITE);
+}
+
+void WavinAHC9000::write_channel_child_lock(uint8_t channel, bool enable) {
+  if (channel < 1 || channel > MAX_CHANNELS) return;
+  if (this->write_is_redundant(channel, FIELD_CHILD_LOCK, enable ? 1 : 0)) return;
+  auto &want = this->desire(channel);
+  want.child_lock = enable;
+  want.pending |= FIELD_CHILD_LOCK;
+  want.unsent |= FIELD_CHILD_LOCK;
+  this->enqueue_channel(channel, PRIO_WRITE);
 }
 
 void WavinAHC9000::write_channel_floor_min_temperature(uint8_t channel, float celsius) {
-  if (channel < 1 || channel > 16) return;
+  if (channel < 1 || channel > MAX_CHANNELS) return;
   // Clamp to a sane range; controller likely enforces further constraints
   if (celsius < 5.0f) celsius = 5.0f;
   if (celsius > 35.0f) celsius = 35.0f;
-  uint8_t page = (uint8_t) (channel - 1);
   uint16_t raw = this->c_to_raw(celsius);
-  if (this->write_register(CAT_PACKED, page, PACKED_FLOOR_MIN_TEMPERATURE, raw)) {
-    this->channels_[channel].floor_min_c = celsius;
-    this->urgent_channels_.push_back(channel);
-  }
+  if (this->write_is_redundant(channel, FIELD_FLOOR_MIN, raw)) return;
+  auto &want = this->desire(channel);
+  want.floor_min_raw = raw;
+  want.pending |= FIELD_FLOOR_MIN;
+  want.unsent |= FIELD_FLOOR_MIN;
+  this->enqueue_channel(channel, PRIO_WRITE);
 }
 
 void WavinAHC9000::write_channel_floor_max_temperature(uint8_t channel, float celsius) {
-  if (channel < 1 || channel > 16) return;
+  if (channel < 1 || channel > MAX_CHANNELS) return;
   if (celsius < 5.0f) celsius = 5.0f;
   if (celsius > 35.0f) celsius = 35.0f;
-  uint8_t page = (uint8_t) (channel - 1);
   uint16_t raw = this->c_to_raw(celsius);
-  if (this->write_register(CAT_PACKED, page, PACKED_FLOOR_MAX_TEMPERATURE, raw)) {
-    this->channels_[channel].floor_max_c = celsius;
-    this->urgent_channels_.push_back(channel);
-  }
+  if (this->write_is_redundant(channel, FIELD_FLOOR_MAX, raw)) return;
+  auto &want = this->desire(channel);
+  want.floor_max_raw = raw;
+  want.pending |= FIELD_FLOOR_MAX;
+  want.unsent |= FIELD_FLOOR_MAX;
+  this->enqueue_channel(channel, PRIO_WRITE);
 }
 
 void WavinAHC9000::write_channel_hysteresis(uint8_t channel, float celsius) {
-  if (channel < 1 || channel > 16) return;
+  if (channel < 1 || channel > MAX_CHANNELS) return;
   // clamp to safe UI bounds: 0.1 .. 1.0 °C
   if (std::isnan(celsius)) return;
   if (celsius < 0.1f) celsius = 0.1f;
   if (celsius > 1.0f) celsius = 1.0f;
-  uint8_t page = (uint8_t) (channel - 1);
   uint16_t raw = (uint16_t) (std::round(celsius * 10.0f));
-  if (this->write_register(CAT_PACKED, page, PACKED_HYSTERESIS, raw)) {
-    this->channels_[channel].hysteresis_c = celsius;
-    this->urgent_channels_.push_back(channel);
+  if (this->write_is_redundant(channel, FIELD_HYSTERESIS, raw)) return;
+  auto &want = this->desire(channel);
+  want.hysteresis_raw = raw;
+  want.pending |= FIELD_HYSTERESIS;
+  want.unsent |= FIELD_HYSTERESIS;
+  this->enqueue_channel(channel, PRIO_WRITE);
+}
+
+uint32_t WavinAHC9000::apply_scene(const std::vector<SceneChange> &changes) {
+  SceneProgress scene{this->next_scene_id_++, millis(), {}, 0, 0};
+  // Every change of the scene counts its latency from the scene call
+  this->command_issued_ms_ = scene.start_ms;
+  // The writers only record targets and queue write jobs, so the whole batch is planned before the
+  // next loop() sends anything: writes for every channel first, then one verification read each.
+  for (const auto &change : changes) {
+    uint8_t ch = change.channel;
+    if (ch < 1 || ch > MAX_CHANNELS) {
+      ESP_LOGW(TAG, "Scene %u: channel %u out of range, skipped", (unsigned) scene.id, (unsigned) ch);
+      continue;
+    }
+    switch (change.field) {
+      case FIELD_SETPOINT: this->write_channel_setpoint(ch, change.value); break;
+      case FIELD_STANDBY_SETPOINT: this->write_channel_standby_setpoint(ch, change.value); break;
+      case FIELD_HYSTERESIS: this->write_channel_hysteresis(ch, change.value); break;
+      case FIELD_FLOOR_MIN: this->write_channel_floor_min_temperature(ch, change.value); break;
+      case FIELD_FLOOR_MAX: this->write_channel_floor_max_temperature(ch, change.value); break;
+      case FIELD_CHILD_LOCK: this->write_channel_child_lock(ch, change.value != 0.0f); break;
+      case FIELD_MODE:
+        if (!this->allow_mode_writes_) {
+          ESP_LOGW(TAG, "Scene %u: mode writes disabled by config; CH%u mode skipped", (unsigned) scene.id, (unsigned) ch);
+          continue;
+        }
+        this->write_channel_mode(ch, change.value != 0.0f ? climate::CLIMATE_MODE_HEAT : climate::CLIMATE_MODE_OFF);
+        break;
+      default:
+        ESP_LOGW(TAG, "Scene %u: unknown field 0x%02X for CH%u, skipped", (unsigned) scene.id, (unsigned) change.field,
+                 (unsigned) ch);
+        continue;
+    }
+    if (std::find(scene.waiting.begin(), scene.waiting.end(), ch) == scene.waiting.end()) scene.waiting.push_back(ch);
+  }
+  this->end_command();
+  ESP_LOGI(TAG, "Scene %u: %u change(s) across %u channel(s)", (unsigned) scene.id, (unsigned) changes.size(),
+           (unsigned) scene.waiting.size());
+
+  // Channels whose changes were all elided (already in place) have nothing left to confirm
+  for (size_t i = 0; i < scene.waiting.size();) {
+    auto want = this->desired_.find(scene.waiting[i]);
+    if (want == this->desired_.end() || want->second.pending == 0) {
+      this->report_scene_channel(scene, scene.waiting[i], true);
+    } else {
+      i++;
+    }
+  }
+  uint32_t id = scene.id;
+  if (!scene.waiting.empty()) {
+    this->scenes_.push_back(std::move(scene));
   } else {
+    ESP_LOGI(TAG, "Scene %u: done in 0ms, %u ok, %u failed", (unsigned) id, (unsigned) scene.ok, (unsigned) scene.failed);
+  }
+  return id;
+}
+
+uint32_t WavinAHC9000::apply_scene(const std::vector<int32_t> &channels, const std::vector<std::string> &fields,
+                                   const std::vector<float> &values) {
+  static const struct {
+    const char *name;
+    uint8_t field;
+  } FIELD_NAMES[] = {
+      {"setpoint", FIELD_SETPOINT},     {"standby_setpoint", FIELD_STANDBY_SETPOINT},
+      {"mode", FIELD_MODE},             {"child_lock", FIELD_CHILD_LOCK},
+      {"hysteresis", FIELD_HYSTERESIS}, {"floor_min", FIELD_FLOOR_MIN},
+      {"floor_max", FIELD_FLOOR_MAX},
+  };
+  size_t n = std::min({channels.size(), fields.size(), values.size()});
+  if (n != channels.size() || n != fields.size() || n != values.size()) {
+    ESP_LOGW(TAG, "Scene: channels/fields/values lengths differ (%u/%u/%u); using the first %u", (unsigned) channels.size(),
+             (unsigned) fields.size(), (unsigned) values.size(), (unsigned) n);
+  }
+  std::vector<SceneChange> changes;
+  changes.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    uint8_t field = 0;
+    for (const auto &f : FIELD_NAMES) {
+      if (fields[i] == f.name) field = f.field;
+    }
+    if (field == 0) {
+      ESP_LOGW(TAG, "Scene: unknown field '%s' skipped", fields[i].c_str());
+      continue;
+    }
+    if (channels[i] < 1 || channels[i] > MAX_CHANNELS) {
+      ESP_LOGW(TAG, "Scene: channel %d out of range, skipped", (int) channels[i]);
+      continue;
+    }
+    changes.push_back(SceneChange{(uint8_t) channels[i], field, values[i]});
+  }
+  return this->apply_scene(changes);
+}
+
+void WavinAHC9000::report_scene_channel(SceneProgress &scene, uint8_t channel, bool ok) {
+  auto pos = std::find(scene.waiting.begin(), scene.waiting.end(), channel);
+  if (pos == scene.waiting.end()) return;
+  scene.waiting.erase(pos);
+  if (ok) {
+    scene.ok++;
+  } else {
+    scene.failed++;
+    ESP_LOGW(TAG, "Scene %u: CH%u did not confirm", (unsigned) scene.id, (unsigned) channel);
+  }
+  for (auto &cb : this->scene_callbacks_) cb(scene.id, channel, ok);
+}
+
+// Reconciler outcome for a channel: settles it in every scene still waiting on it
+void WavinAHC9000::scene_result(uint8_t channel, bool ok) {
+  for (auto it = this->scenes_.begin(); it != this->scenes_.end();) {
+    this->report_scene_channel(*it, channel, ok);
+    if (!it->waiting.empty()) {
+      ++it;
+      continue;
+    }
+    ESP_LOGI(TAG, "Scene %u: done in %ums, %u ok, %u failed", (unsigned) it->id, (unsigned) (millis() - it->start_ms),
+             (unsigned) it->ok, (unsigned) it->failed);
+    it = this->scenes_.erase(it);
+  }
+}
+
+// Executes the queued write job for one channel: sends every field the user changed since the last
+// job, then hands the channel to PRIO_VERIFY so the reconciler can confirm the values.
+void WavinAHC9000::apply_pending_writes(uint8_t channel) {
+  if (!this->prepare_write_job(channel, this->write_job_)) {
+    this->enqueue_channel(channel, PRIO_VERIFY);
+    return;
+  }
+#ifdef WAVIN_AHC9000_IO_TASK
+  if (this->io_running_) {
+    this->io_post(IO_JOB_WRITE, BusRequest{IO_WRITE_JOB, 0, 0, 0, 0});
+    return;
+  }
+#endif
+  this->run_write_job(this->write_job_);
+  this->finish_write_job(this->write_job_);
+}
+
+// Main loop side of a write job: takes the unsent fields and turns them into register writes
+bool WavinAHC9000::prepare_write_job(uint8_t channel, WriteJob &job) {
+  auto it = this->desired_.find(channel);
+  if (it == this->desired_.end()) return false;
+  auto &want = it->second;
+  auto &st = this->channels_[channel];
+  uint8_t todo = want.unsent;
+  want.unsent = 0;
+  if (want.sent_ms == 0) want.sent_ms = millis();
+  // Entities may have published optimistic values; make sure the read-back gets through the filters
+  this->forget_published(channel);
+  // Even an unacknowledged write may have landed: the next routine poll of the channel reads everything
+  this->full_read_ms_[channel - 1] = 0;
+
+  job = WriteJob{};
+  job.channel = channel;
+  job.todo = todo;
+  job.mode = want.mode;
+  job.child_lock = want.child_lock;
+  job.relearn_multi_write = this->multi_write_relearn_;
+  this->multi_write_relearn_ = false;
+  // Collected first and sent as one batch, so adjacent registers (floor min/max) share a transaction
+  if (todo & FIELD_SETPOINT) job.writes[job.count++] = {PACKED_MANUAL_TEMPERATURE, want.setpoint_raw, FIELD_SETPOINT};
+  if (todo & FIELD_STANDBY_SETPOINT) job.writes[job.count++] = {PACKED_STANDBY_TEMPERATURE, want.standby_raw, FIELD_STANDBY_SETPOINT};
+  job.config_fields = todo & (FIELD_MODE | FIELD_CHILD_LOCK);
+  if (want.config_exact) {
+    // Normalize: the exact baseline value, mode and lock included
+    job.config_fields = FIELD_MODE | FIELD_CHILD_LOCK;
+    job.config_exact = true;
+    job.writes[job.count++] = {PACKED_CONFIGURATION, want.config_exact_raw, job.config_fields};
+    want.config_exact = false;
+  } else if (job.config_fields) {
+    // Read-Modify-Write to preserve existing flags (Program, etc.); mode and lock share one write
+    if (todo & FIELD_MODE) {
+      uint16_t new_bits = (want.mode == climate::CLIMATE_MODE_OFF) ? PACKED_CONFIGURATION_MODE_STANDBY : PACKED_CONFIGURATION_MODE_MANUAL;
+      // Clear Program/Schedule bits (0x0018) when manually changing mode to prevent controller revert
+      job.config_and &= (uint16_t) ~(PACKED_CONFIGURATION_MODE_MASK | PACKED_CONFIGURATION_PROGRAM_MASK);
+      job.config_or |= (uint16_t) (new_bits & PACKED_CONFIGURATION_MODE_MASK);
+      // Fallback to strict baseline if the read fails, keeping the child lock from the desired state, else from cache
+      bool lock = (want.pending & FIELD_CHILD_LOCK) ? want.child_lock : st.child_lock;
+      job.config_strict = true;
+      job.config_strict_value = (uint16_t) (0x4000 | new_bits | (lock ? PACKED_CONFIGURATION_CHILD_LOCK_MASK : 0));
+    }
+    if (todo & FIELD_CHILD_LOCK) {
+      if (want.child_lock) {
+        job.config_or |= PACKED_CONFIGURATION_CHILD_LOCK_MASK;
+      } else {
+        job.config_and &= (uint16_t) ~PACKED_CONFIGURATION_CHILD_LOCK_MASK;
+      }
+    }
+    // Child lock alone with an unreadable register: nothing is written, the reconciler retries
+  }
+  if (todo & FIELD_FLOOR_MIN) job.writes[job.count++] = {PACKED_FLOOR_MIN_TEMPERATURE, want.floor_min_raw, FIELD_FLOOR_MIN};
+  if (todo & FIELD_FLOOR_MAX) job.writes[job.count++] = {PACKED_FLOOR_MAX_TEMPERATURE, want.floor_max_raw, FIELD_FLOOR_MAX};
+  if (todo & FIELD_HYSTERESIS) job.writes[job.count++] = {PACKED_HYSTERESIS, want.hysteresis_raw, FIELD_HYSTERESIS};
+  return true;
+}
+
+// Bus side of a write job; runs on the I/O task when there is one, so it only touches the job and
+// the transaction engine
+void WavinAHC9000::run_write_job(WriteJob &job) {
+  // Possibly different firmware: learn multi-register write support again
+  if (job.relearn_multi_write) this->multi_write_ = MULTI_WRITE_UNKNOWN;
+  job.multi_write_before = this->multi_write_;
+  uint8_t page = (uint8_t) (job.channel - 1);
+  PendingWrite batch[FIELD_COUNT];
+  uint8_t n = job.count;
+  std::copy(job.writes, job.writes + n, batch);
+  if (job.config_fields && !job.config_exact) {
+    std::vector<uint16_t> regs;
+    if (this->exec_read(CAT_PACKED, page, PACKED_CONFIGURATION, 1, regs) && regs.size() >= 1) {
+      job.config_read = true;
+      job.config_from = regs[0];
+      job.config_to = (uint16_t) ((regs[0] & job.config_and) | job.config_or);
+      if (job.config_to != job.config_from) {
+        batch[n++] = {PACKED_CONFIGURATION, job.config_to, job.config_fields};
+      } else {
+        job.acked |= job.config_fields;
+      }
+    } else if (job.config_strict) {
+      job.config_to = job.config_strict_value;
+      batch[n++] = {PACKED_CONFIGURATION, job.config_strict_value, job.config_fields};
+    }
+  }
+  job.acked |= this->write_batch(page, batch, n);
+  job.multi_write_after = this->multi_write_;
+}
+
+// Main loop side again: acknowledged values go to the cache and the channel is queued for verification
+void WavinAHC9000::finish_write_job(const WriteJob &job) {
+  uint8_t channel = job.channel;
+  if (job.multi_write_after != job.multi_write_before) {
+    if (job.multi_write_after == MULTI_WRITE_SUPPORTED) {
+      ESP_LOGI(TAG, "Controller applies multi-register writes; merging adjacent register writes");
+    } else if (job.multi_write_after == MULTI_WRITE_UNSUPPORTED) {
+      ESP_LOGW(TAG, "Multi-register write left registers past the first unchanged; using single-register writes");
+    }
+  }
+  auto &st = this->channels_[channel];
+  auto sent = [&job](uint8_t field) {
+    for (uint8_t i = 0; i < job.count; i++) {
+      if (job.writes[i].fields & field) return job.writes[i].value;
+    }
+    return (uint16_t) 0;
+  };
+  uint8_t acked = job.acked;
+  if (acked & FIELD_SETPOINT) st.setpoint_c = this->raw_to_c(sent(FIELD_SETPOINT));
+  if (acked & FIELD_STANDBY_SETPOINT) st.standby_setpoint_c = this->raw_to_c(sent(FIELD_STANDBY_SETPOINT));
+  if (job.config_exact) {
+    if (acked & job.config_fields) {
+      ESP_LOGW(TAG, "Normalize (strict) applied: ch=%u -> 0x%04X", (unsigned) channel, (unsigned) sent(FIELD_MODE));
+    } else {
+      ESP_LOGW(TAG, "Normalize (strict) failed: write not acknowledged for ch=%u", (unsigned) channel);
+    }
+  } else if (job.config_fields) {
+    if (!job.config_read && job.config_strict)
+      ESP_LOGW(TAG, "Mode RMW failed, using strict write ch=%u val=0x%04X", (unsigned) channel, (unsigned) job.config_to);
+    if ((acked & job.config_fields) == job.config_fields) {
+      if (job.config_read && job.config_from != job.config_to)
+        ESP_LOGD(TAG, "Config RMW ch=%u: 0x%04X -> 0x%04X", (unsigned) channel, (unsigned) job.config_from, (unsigned) job.config_to);
+      if (job.todo & FIELD_MODE) st.mode = job.mode;
+      if (job.todo & FIELD_CHILD_LOCK) st.child_lock = job.child_lock;
+    } else {
+      ESP_LOGW(TAG, "Config write failed for ch=%u (reconciler will retry)", (unsigned) channel);
+    }
+  }
+  if (acked & FIELD_FLOOR_MIN) st.floor_min_c = this->raw_to_c(sent(FIELD_FLOOR_MIN));
+  if (acked & FIELD_FLOOR_MAX) st.floor_max_c = this->raw_to_c(sent(FIELD_FLOOR_MAX));
+  if (acked & FIELD_HYSTERESIS) {
+    st.hysteresis_c = (float) sent(FIELD_HYSTERESIS) / 10.0f;
+  } else if (job.todo & FIELD_HYSTERESIS) {
     ESP_LOGW(TAG, "Hysteresis write failed for ch=%u", (unsigned) channel);
   }
+  // Acknowledged values are applied to the cache
+  this->state_seq_++;
+  auto want = this->desired_.find(channel);
+  if (want != this->desired_.end()) want->second.acked_ms = millis();
+  this->enqueue_channel(channel, PRIO_VERIFY);
 }
 
 void WavinAHC9000::set_strict_mode_write(uint8_t channel, bool enable) {
-  if (channel < 1 || channel > 16) return;
+  if (channel < 1 || channel > MAX_CHANNELS) return;
   if (enable) this->strict_mode_channels_.insert(channel);
   else this->strict_mode_channels_.erase(channel);
 }
@@ -682,175 +1974,492 @@ bool WavinAHC9000::is_strict_mode_write(uint8_t channel) const {
 }
 
 void WavinAHC9000::refresh_channel_now(uint8_t channel) {
-  if (channel < 1 || channel > 16) return;
-  // Just schedule urgent refresh; actual reads happen in update()
-  this->urgent_channels_.push_back(channel);
+  if (channel < 1 || channel > MAX_CHANNELS) return;
+  this->enqueue_channel(channel, PRIO_VERIFY, true);
 }
 
 void WavinAHC9000::normalize_channel_config(uint8_t channel, bool off) {
-  if (channel < 1 || channel > 16) return;
-  uint8_t page = (uint8_t) (channel - 1);
+  if (channel < 1 || channel > MAX_CHANNELS) return;
   // Force PACKED_CONFIGURATION to exact baseline used by healthy channels
   uint16_t value = (uint16_t) (0x4000 | (off ? PACKED_CONFIGURATION_MODE_STANDBY : PACKED_CONFIGURATION_MODE_MANUAL));
-  if (this->write_register(CAT_PACKED, page, PACKED_CONFIGURATION, value)) {
-    ESP_LOGW(TAG, "Normalize (strict) applied: ch=%u -> 0x%04X", (unsigned) channel, (unsigned) value);
-    this->urgent_channels_.push_back(channel);
+  // Baseline clears the child lock bit too; keep the reconciler from restoring stale targets
+  auto &want = this->desire(channel);
+  want.mode = off ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
+  want.child_lock = false;
+  want.pending |= FIELD_MODE | FIELD_CHILD_LOCK;
+  want.unsent &= (uint8_t) ~(FIELD_MODE | FIELD_CHILD_LOCK);
+  want.config_exact = true;
+  want.config_exact_raw = value;
+  this->enqueue_channel(channel, PRIO_WRITE);
+}
+
+template<typename T> static T *find_entity(const std::map<uint8_t, T *> &entities, uint8_t ch) {
+  auto it = entities.find(ch);
+  return it == entities.end() ? nullptr : it->second;
+}
+
+void WavinAHC9000::set_max_publishes_per_second(uint16_t n) {
+  if (n == 0) n = 1;
+  this->publish_spacing_ms_ = 1000u / n;
+}
+
+// Queue a channel whose read set just completed; its entities are published by drain_publish_queue()
+void WavinAHC9000::queue_publish(uint8_t ch) {
+  if (std::find(this->publish_queue_.begin(), this->publish_queue_.end(), ch) != this->publish_queue_.end()) return;
+  this->publish_queue_.push_back(ch);
+}
+
+// Publish at most one entity per loop() call and no more often than the configured rate, walking the
+// entity kinds of the channel at the front of the queue. Keeps the API connection free of bursts.
+void WavinAHC9000::drain_publish_queue() {
+  if (this->publish_queue_.empty()) return;
+  uint32_t now = millis();
+  if (now - this->last_publish_ms_ < this->publish_spacing_ms_) return;
+  uint8_t ch = this->publish_queue_.front();
+  while (this->publish_kind_ < PUB_COUNT) {
+    if (this->publish_channel_entity(ch, this->publish_kind_++)) {
+      this->last_publish_ms_ = now;
+      break;
+    }
+  }
+  if (this->publish_kind_ >= PUB_COUNT) {
+    ESP_LOGV(TAG, "CH%u: published", ch);
+    this->publish_queue_.pop_front();
+    this->publish_kind_ = 0;
+    if (!this->awaiting_publish_.empty()) this->command_published(ch);
+  }
+}
+
+// Last stage of a command: the confirmed state reached the entities. Records the end-to-end latency,
+// republishes the percentiles and logs the stage breakdown of slow commands:
+// queue = issue -> first write job, bus = write jobs, confirm = read-back and corrections,
+// publish = paced entity fan-out.
+void WavinAHC9000::command_published(uint8_t ch) {
+  auto it = this->awaiting_publish_.find(ch);
+  if (it == this->awaiting_publish_.end()) return;
+  const CommandTiming &cmd = it->second;
+  uint32_t now = millis();
+  uint32_t total = now - cmd.issued_ms;
+  uint32_t queue = cmd.sent_ms - cmd.issued_ms;
+  uint32_t bus = cmd.acked_ms - cmd.sent_ms;
+  uint32_t confirm = cmd.confirmed_ms - cmd.acked_ms;
+  uint32_t publish = now - cmd.confirmed_ms;
+  if (total >= this->slow_command_ms_) {
+    ESP_LOGW(TAG, "CH%u: slow command #%u took %ums (queue %u, bus %u, confirm %u in %u pass(es), publish %u)", ch,
+             (unsigned) cmd.id, (unsigned) total, (unsigned) queue, (unsigned) bus, (unsigned) confirm,
+             (unsigned) cmd.passes + 1, (unsigned) publish);
   } else {
-    ESP_LOGW(TAG, "Normalize (strict) failed: write not acknowledged for ch=%u", (unsigned) channel);
-  }
-}
-
-void WavinAHC9000::publish_updates() {
-  ESP_LOGV(TAG, "Publishing updates: %u single climates, %u group climates",
-           (unsigned) this->single_ch_climates_.size(), (unsigned) this->group_climates_.size());
-  for (auto *c : this->single_ch_climates_) c->update_from_parent();
-  for (auto *c : this->group_climates_) c->update_from_parent();
-  // Channel sensors
-  for (auto &kv : this->temperature_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    float v = this->get_channel_current_temp(ch);
-    if (!std::isnan(v)) s->publish_state(v);
-  }
-  for (auto &kv : this->battery_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end() && it->second.battery_pct != 255) {
-      s->publish_state((float) it->second.battery_pct);
-    }
-  }
-  for (auto &kv : this->comfort_setpoint_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    float v = this->get_channel_setpoint(ch);
-    if (!std::isnan(v)) s->publish_state(v);
-  }
-  for (auto &kv : this->floor_temperature_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end() && it->second.has_floor_sensor) {
-      float v = it->second.floor_temp_c;
-      if (!std::isnan(v)) s->publish_state(v);
-    }
-  }
-  // Publish floor limit sensors (read-only)
-  for (auto &kv : this->floor_min_temperature_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      float v = it->second.floor_min_c;
-      if (!std::isnan(v)) s->publish_state(v);
-    }
-  }
-  for (auto &kv : this->floor_max_temperature_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      float v = it->second.floor_max_c;
-      if (!std::isnan(v)) s->publish_state(v);
-    }
-  }
-
-  // Publish RSSI sensors
-  for (auto &kv : this->rssi_element_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      float v = it->second.rssi_element_dbm;
-      if (!std::isnan(v)) s->publish_state(v);
-    }
-  }
-  for (auto &kv : this->rssi_cu_sensors_) {
-    uint8_t ch = kv.first;
-    auto *s = kv.second;
-    if (!s) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      float v = it->second.rssi_cu_dbm;
-      if (!std::isnan(v)) s->publish_state(v);
-    }
-  }
-
-
-  // Publish configured number entities (setpoints and hysteresis)
-  for (auto &kv : this->comfort_numbers_) {
-    uint8_t ch = kv.first;
-    auto *n = kv.second;
-    if (!n) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end() && !std::isnan(it->second.setpoint_c)) {
-      n->publish_state(it->second.setpoint_c);
-    }
-  }
-  for (auto &kv : this->standby_numbers_) {
-    uint8_t ch = kv.first;
-    auto *n = kv.second;
-    if (!n) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end() && !std::isnan(it->second.standby_setpoint_c)) {
-      n->publish_state(it->second.standby_setpoint_c);
-    }
-  }
-  for (auto &kv : this->hysteresis_numbers_) {
-    uint8_t ch = kv.first;
-    auto *n = kv.second;
-    if (!n) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end() && !std::isnan(it->second.hysteresis_c)) {
-      n->publish_state(it->second.hysteresis_c);
-    }
-  }
-  // Child lock switches
-  for (auto &kv : this->child_lock_switches_) {
-    uint8_t ch = kv.first;
-    auto *sw = kv.second;
-    if (!sw) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      sw->publish_state(it->second.child_lock);
-    }
-  }
-  // Standby switches
-  for (auto &kv : this->standby_switches_) {
-    uint8_t ch = kv.first;
-    auto *sw = kv.second;
-    if (!sw) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      sw->publish_state(it->second.mode == climate::CLIMATE_MODE_OFF);
-    }
-  }
-  // Output binary sensors (Valve open/closed)
-  for (auto &kv : this->output_binary_sensors_) {
-    uint8_t ch = kv.first;
-    auto *bs = kv.second;
-    if (!bs) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      bs->publish_state(it->second.action == climate::CLIMATE_ACTION_HEATING);
-    }
-  }
-  // Problem binary sensors (TP Lost)
-  for (auto &kv : this->problem_binary_sensors_) {
-    uint8_t ch = kv.first;
-    auto *bs = kv.second;
-    if (!bs) continue;
-    auto it = this->channels_.find(ch);
-    if (it != this->channels_.end()) {
-      bs->publish_state(it->second.all_tp_lost);
+    ESP_LOGD(TAG, "CH%u: command #%u took %ums (queue %u, bus %u, confirm %u, publish %u)", ch, (unsigned) cmd.id,
+             (unsigned) total, (unsigned) queue, (unsigned) bus, (unsigned) confirm, (unsigned) publish);
+  }
+  this->awaiting_publish_.erase(it);
+
+  this->latency_ms_[this->latency_pos_] = total;
+  this->latency_pos_ = (uint8_t) ((this->latency_pos_ + 1) % LATENCY_WINDOW);
+  if (this->latency_count_ < LATENCY_WINDOW) this->latency_count_++;
+#ifdef WAVIN_AHC9000_SENSOR
+  if (this->latency_p50_sensor_ == nullptr && this->latency_p95_sensor_ == nullptr) return;
+  uint32_t sorted[LATENCY_WINDOW];
+  std::copy(this->latency_ms_, this->latency_ms_ + this->latency_count_, sorted);
+  std::sort(sorted, sorted + this->latency_count_);
+  auto pct = [&](uint8_t p) { return (float) sorted[(this->latency_count_ - 1) * p / 100]; };
+  if (this->latency_p50_sensor_ != nullptr) this->latency_p50_sensor_->publish_state(pct(50));
+  if (this->latency_p95_sensor_ != nullptr) this->latency_p95_sensor_->publish_state(pct(95));
+#endif
+}
+
+void WavinAHC9000::set_publish_policy(uint8_t cls, float min_delta, uint32_t heartbeat_ms, uint32_t min_interval_ms) {
+  if (cls >= POLICY_COUNT) return;
+  this->publish_policies_[cls] = PublishPolicy{min_delta, heartbeat_ms, min_interval_ms};
+}
+
+static uint8_t policy_class_for(uint8_t kind) {
+  switch (kind) {
+    case WavinAHC9000::PUB_TEMPERATURE:
+    case WavinAHC9000::PUB_FLOOR_TEMPERATURE:
+      return WavinAHC9000::POLICY_TEMPERATURE;
+    case WavinAHC9000::PUB_RSSI_ELEMENT:
+    case WavinAHC9000::PUB_RSSI_CU:
+      return WavinAHC9000::POLICY_RSSI;
+    case WavinAHC9000::PUB_BATTERY:
+      return WavinAHC9000::POLICY_BATTERY;
+    case WavinAHC9000::PUB_TEMPERATURE_TREND:
+    case WavinAHC9000::PUB_FLOOR_TEMPERATURE_TREND:
+      return WavinAHC9000::POLICY_TREND;
+    case WavinAHC9000::PUB_DUTY_CYCLE:
+    case WavinAHC9000::PUB_ON_TIME:
+      return WavinAHC9000::POLICY_STATISTICS;
+    case WavinAHC9000::PUB_COMFORT_SETPOINT:
+    case WavinAHC9000::PUB_FLOOR_MIN:
+    case WavinAHC9000::PUB_FLOOR_MAX:
+    case WavinAHC9000::PUB_COMFORT_NUMBER:
+    case WavinAHC9000::PUB_STANDBY_NUMBER:
+    case WavinAHC9000::PUB_HYSTERESIS_NUMBER:
+      return WavinAHC9000::POLICY_SETPOINT;
+    default:
+      return WavinAHC9000::POLICY_STATE;
+  }
+}
+
+// Publish policy gate: a value goes out if it is the first one, if it moved at least min_delta from
+// the last *published* value (so slow drift still accumulates into a publish), or if the heartbeat
+// interval has passed. Nothing is published more often than min_interval; a change that arrives
+// sooner is held and published by flush_held_publishes() once the interval is over. Booleans are
+// passed as 0/1 and publish on any change. Records the value when it returns true.
+bool WavinAHC9000::publish_allowed(uint8_t ch, uint8_t kind, float value) {
+  const PublishPolicy &policy = this->publish_policies_[policy_class_for(kind)];
+  auto &memo = this->publish_memo_[(uint16_t) ((ch << 8) | kind)];
+  uint32_t now = millis();
+  if (memo.valid) {
+    uint32_t elapsed = now - memo.last_ms;
+    // small epsilon so a 0.1 delta matches 0.1 °C steps despite float rounding
+    bool moved = value != memo.value && std::fabs(value - memo.value) >= policy.min_delta - 0.001f;
+    if (elapsed < policy.min_interval_ms) {
+      if (moved) {
+        uint32_t due = memo.last_ms + policy.min_interval_ms;
+        if (!this->publish_held_ || (int32_t) (due - this->publish_held_due_ms_) < 0) this->publish_held_due_ms_ = due;
+        memo.held = true;
+        this->publish_held_ = true;
+      }
+      return false;
     }
+    memo.held = false;
+    bool heartbeat_due = policy.heartbeat_ms != 0 && elapsed >= policy.heartbeat_ms;
+    if (!heartbeat_due && !moved) return false;
+  }
+  memo.valid = true;
+  memo.value = value;
+  memo.last_ms = now;
+  return true;
+}
+
+// Publishing goes through the channel's read set otherwise, which may be a full poll interval away
+void WavinAHC9000::flush_held_publishes() {
+  if (!this->publish_held_) return;
+  uint32_t now = millis();
+  if ((int32_t) (now - this->publish_held_due_ms_) < 0) return;
+  this->publish_held_ = false;
+  for (auto &kv : this->publish_memo_) {
+    PublishMemo &memo = kv.second;
+    if (!memo.held) continue;
+    uint32_t due = memo.last_ms + this->publish_policies_[policy_class_for((uint8_t) (kv.first & 0xFF))].min_interval_ms;
+    if ((int32_t) (now - due) < 0) {
+      if (!this->publish_held_ || (int32_t) (due - this->publish_held_due_ms_) < 0) this->publish_held_due_ms_ = due;
+      this->publish_held_ = true;
+      continue;
+    }
+    // publish_allowed() compares the cached value with the last publish again when the channel is drained
+    memo.held = false;
+    this->queue_publish((uint8_t) (kv.first >> 8));
+  }
+}
+
+void WavinAHC9000::forget_published(uint8_t ch) {
+  auto first = this->publish_memo_.lower_bound((uint16_t) (ch << 8));
+  auto last = this->publish_memo_.lower_bound((uint16_t) ((ch + 1) << 8));
+  this->publish_memo_.erase(first, last);
+  // Entities with optimistic state need the next read-back even if the cache did not move
+  this->notified_.erase(ch);
+}
+
+// Returns true if an entity of the given kind exists for the channel and was published
+bool WavinAHC9000::publish_channel_entity(uint8_t ch, uint8_t kind) {
+  auto it = this->channels_.find(ch);
+  if (it == this->channels_.end()) return false;
+  const ChannelState &st = it->second;
+  (void) st;  // only the climate cases remain in a climate-only build
+  switch (kind) {
+    case PUB_CLIMATE: {
+      bool any = false;
+      for (auto *c : this->single_ch_climates_) {
+        if (c->get_single_channel() == ch && c->publish_if_dirty()) any = true;
+      }
+      return any;
+    }
+    case PUB_GROUP_CLIMATE: {
+      bool any = false;
+      for (auto *c : this->group_climates_) {
+        const auto &m = c->get_members();
+        if (std::find(m.begin(), m.end(), ch) != m.end() && c->publish_if_dirty()) any = true;
+      }
+      return any;
+    }
+#ifdef WAVIN_AHC9000_SENSOR
+    case PUB_TEMPERATURE: {
+      auto *s = find_entity(this->temperature_sensors_, ch);
+      if (s == nullptr || std::isnan(st.current_temp_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.current_temp_c)) return false;
+      s->publish_state(st.current_temp_c);
+      return true;
+    }
+    case PUB_FLOOR_TEMPERATURE: {
+      auto *s = find_entity(this->floor_temperature_sensors_, ch);
+      if (s == nullptr || !st.has_floor_sensor || std::isnan(st.floor_temp_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.floor_temp_c)) return false;
+      s->publish_state(st.floor_temp_c);
+      return true;
+    }
+    case PUB_BATTERY: {
+      auto *s = find_entity(this->battery_sensors_, ch);
+      if (s == nullptr || st.battery_pct == 255) return false;
+      if (!this->publish_allowed(ch, kind, (float) st.battery_pct)) return false;
+      s->publish_state((float) st.battery_pct);
+      return true;
+    }
+    case PUB_COMFORT_SETPOINT: {
+      auto *s = find_entity(this->comfort_setpoint_sensors_, ch);
+      if (s == nullptr || std::isnan(st.setpoint_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.setpoint_c)) return false;
+      s->publish_state(st.setpoint_c);
+      return true;
+    }
+    // Floor limit sensors (read-only)
+    case PUB_FLOOR_MIN: {
+      auto *s = find_entity(this->floor_min_temperature_sensors_, ch);
+      if (s == nullptr || std::isnan(st.floor_min_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.floor_min_c)) return false;
+      s->publish_state(st.floor_min_c);
+      return true;
+    }
+    case PUB_FLOOR_MAX: {
+      auto *s = find_entity(this->floor_max_temperature_sensors_, ch);
+      if (s == nullptr || std::isnan(st.floor_max_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.floor_max_c)) return false;
+      s->publish_state(st.floor_max_c);
+      return true;
+    }
+    case PUB_RSSI_ELEMENT: {
+      auto *s = find_entity(this->rssi_element_sensors_, ch);
+      if (s == nullptr || std::isnan(st.rssi_element_dbm)) return false;
+      if (!this->publish_allowed(ch, kind, st.rssi_element_dbm)) return false;
+      s->publish_state(st.rssi_element_dbm);
+      return true;
+    }
+    case PUB_RSSI_CU: {
+      auto *s = find_entity(this->rssi_cu_sensors_, ch);
+      if (s == nullptr || std::isnan(st.rssi_cu_dbm)) return false;
+      if (!this->publish_allowed(ch, kind, st.rssi_cu_dbm)) return false;
+      s->publish_state(st.rssi_cu_dbm);
+      return true;
+    }
+#endif
+#ifdef WAVIN_AHC9000_NUMBER
+    // Number entities (setpoints and hysteresis)
+    case PUB_COMFORT_NUMBER: {
+      auto *n = find_entity(this->comfort_numbers_, ch);
+      if (n == nullptr || std::isnan(st.setpoint_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.setpoint_c)) return false;
+      n->publish_state(st.setpoint_c);
+      return true;
+    }
+    case PUB_STANDBY_NUMBER: {
+      auto *n = find_entity(this->standby_numbers_, ch);
+      if (n == nullptr || std::isnan(st.standby_setpoint_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.standby_setpoint_c)) return false;
+      n->publish_state(st.standby_setpoint_c);
+      return true;
+    }
+    case PUB_HYSTERESIS_NUMBER: {
+      auto *n = find_entity(this->hysteresis_numbers_, ch);
+      if (n == nullptr || std::isnan(st.hysteresis_c)) return false;
+      if (!this->publish_allowed(ch, kind, st.hysteresis_c)) return false;
+      n->publish_state(st.hysteresis_c);
+      return true;
+    }
+#endif
+#ifdef WAVIN_AHC9000_SWITCH
+    case PUB_CHILD_LOCK: {
+      auto *sw = find_entity(this->child_lock_switches_, ch);
+      if (sw == nullptr) return false;
+      bool v = st.child_lock;
+      if (!this->publish_allowed(ch, kind, v ? 1.0f : 0.0f)) return false;
+      sw->publish_state(v);
+      return true;
+    }
+    case PUB_STANDBY_SWITCH: {
+      auto *sw = find_entity(this->standby_switches_, ch);
+      if (sw == nullptr) return false;
+      bool v = st.mode == climate::CLIMATE_MODE_OFF;
+      if (!this->publish_allowed(ch, kind, v ? 1.0f : 0.0f)) return false;
+      sw->publish_state(v);
+      return true;
+    }
+#endif
+#ifdef WAVIN_AHC9000_BINARY_SENSOR
+    // Output binary sensor (Valve open/closed)
+    case PUB_OUTPUT: {
+      auto *bs = find_entity(this->output_binary_sensors_, ch);
+      if (bs == nullptr) return false;
+      bool v = st.action == climate::CLIMATE_ACTION_HEATING;
+      if (!this->publish_allowed(ch, kind, v ? 1.0f : 0.0f)) return false;
+      bs->publish_state(v);
+      return true;
+    }
+    // Problem binary sensor (TP Lost)
+    case PUB_PROBLEM: {
+      auto *bs = find_entity(this->problem_binary_sensors_, ch);
+      if (bs == nullptr) return false;
+      bool v = st.all_tp_lost;
+      if (!this->publish_allowed(ch, kind, v ? 1.0f : 0.0f)) return false;
+      bs->publish_state(v);
+      return true;
+    }
+#endif
+#ifdef WAVIN_AHC9000_SENSOR
+    // History-derived sensors
+    case PUB_TEMPERATURE_TREND:
+    case PUB_FLOOR_TEMPERATURE_TREND:
+    case PUB_DUTY_CYCLE:
+    case PUB_ON_TIME: {
+      auto hist = this->histories_.find(ch);
+      if (hist == this->histories_.end()) return false;
+      const ChannelHistory &h = hist->second;
+      sensor::Sensor *s;
+      float v;
+      if (kind == PUB_TEMPERATURE_TREND) {
+        s = find_entity(this->temperature_trend_sensors_, ch);
+        v = h.air_trend_c_per_hour();
+      } else if (kind == PUB_FLOOR_TEMPERATURE_TREND) {
+        s = find_entity(this->floor_temperature_trend_sensors_, ch);
+        v = h.floor_trend_c_per_hour();
+      } else if (kind == PUB_DUTY_CYCLE) {
+        s = find_entity(this->duty_cycle_sensors_, ch);
+        v = h.duty_cycle_pct();
+      } else {
+        s = find_entity(this->on_time_sensors_, ch);
+        v = h.on_time_hours_per_day();
+      }
+      if (s == nullptr || std::isnan(v)) return false;
+      if (!this->publish_allowed(ch, kind, v)) return false;
+      s->publish_state(v);
+      return true;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+// --- ChannelHistory ---
+
+void ChannelHistory::init(uint16_t capacity, uint32_t window_ms) {
+  this->ring_.assign(capacity < 2 ? 2 : capacity, Sample{0, DELTA_MISSING, DELTA_MISSING});
+  this->window_ms_ = window_ms;
+  this->head_ = 0;
+  this->count_ = 0;
+}
+
+static int8_t encode_delta(float c, int16_t &running, bool &known) {
+  if (std::isnan(c)) return -128;  // DELTA_MISSING
+  int16_t v = (int16_t) std::lround(c * 10.0f);
+  if (!known) {
+    // First value of this series: earlier samples are all missing, so it becomes the reference
+    running = v;
+    known = true;
+    return 0;
+  }
+  // Saturate; the running value follows what was encoded so the error is corrected next sample
+  int d = v - running;
+  if (d > 127) d = 127;
+  if (d < -127) d = -127;
+  running = (int16_t) (running + d);
+  return (int8_t) d;
+}
+
+void ChannelHistory::add(uint32_t now_ms, float air_c, float floor_c, bool output) {
+  if (this->ring_.empty()) return;
+  bool was_known_air = this->air_known_, was_known_floor = this->floor_known_;
+  Sample smp;
+  uint32_t dt_s = this->count_ == 0 ? 0 : (now_ms - this->last_ms_) / 1000u;
+  if (dt_s > 0x7FFF) dt_s = 0x7FFF;
+  smp.dt_out = (uint16_t) (dt_s | (output ? OUTPUT_BIT : 0));
+  smp.d_air = encode_delta(air_c, this->run_air_, this->air_known_);
+  smp.d_floor = encode_delta(floor_c, this->run_floor_, this->floor_known_);
+  if (!was_known_air && this->air_known_) this->base_air_ = this->run_air_;
+  if (!was_known_floor && this->floor_known_) this->base_floor_ = this->run_floor_;
+
+  // Accumulate on-time for the interval that just ended (output state of the previous sample)
+  this->roll_buckets(now_ms);
+  if (this->count_ > 0 && (this->at(this->count_ - 1).dt_out & OUTPUT_BIT)) {
+    uint32_t on = this->on_s_[this->bucket_] + dt_s;
+    this->on_s_[this->bucket_] = (uint16_t) (on > 3600 ? 3600 : on);
+  }
+
+  if (this->count_ == this->ring_.size()) this->evict_oldest();
+  if (this->count_ == 0) this->base_ms_ = now_ms;
+  this->ring_[(this->head_ + this->count_) % this->ring_.size()] = smp;
+  this->count_++;
+  this->last_ms_ = now_ms;
+  while (this->count_ > 2 && this->last_ms_ - this->base_ms_ > this->window_ms_) this->evict_oldest();
+}
+
+void ChannelHistory::evict_oldest() {
+  if (this->count_ == 0) return;
+  this->head_ = (uint16_t) ((this->head_ + 1) % this->ring_.size());
+  this->count_--;
+  if (this->count_ == 0) return;
+  // Re-base on the new oldest sample: apply its deltas to the reference values
+  const Sample &next = this->at(0);
+  this->base_ms_ += (uint32_t) (next.dt_out & ~OUTPUT_BIT) * 1000u;
+  if (next.d_air != DELTA_MISSING) this->base_air_ = (int16_t) (this->base_air_ + next.d_air);
+  if (next.d_floor != DELTA_MISSING) this->base_floor_ = (int16_t) (this->base_floor_ + next.d_floor);
+}
+
+// Least-squares slope over the window, in °C per hour. NAN until 10 minutes of data are available.
+float ChannelHistory::trend_c_per_hour(bool floor) const {
+  if (floor ? !this->floor_known_ : !this->air_known_) return NAN;
+  int16_t running = floor ? this->base_floor_ : this->base_air_;
+  uint32_t t_s = 0;
+  double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+  uint32_t first_s = 0, last_s = 0;
+  for (uint16_t i = 0; i < this->count_; i++) {
+    const Sample &smp = this->at(i);
+    int8_t d = floor ? smp.d_floor : smp.d_air;
+    if (i > 0) {
+      t_s += smp.dt_out & ~OUTPUT_BIT;
+      if (d != DELTA_MISSING) running = (int16_t) (running + d);
+    }
+    if (d == DELTA_MISSING) continue;
+    double x = t_s / 3600.0, y = running / 10.0;
+    if (n == 0) first_s = t_s;
+    last_s = t_s;
+    n++;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+  }
+  if (n < 2 || last_s - first_s < 600) return NAN;
+  double den = n * sxx - sx * sx;
+  if (den <= 0) return NAN;
+  return (float) ((n * sxy - sx * sy) / den);
+}
+
+// Time-weighted share of the window during which the output (valve) was on
+float ChannelHistory::duty_cycle_pct() const {
+  uint32_t total = 0, on = 0;
+  for (uint16_t i = 1; i < this->count_; i++) {
+    uint32_t dt = this->at(i).dt_out & ~OUTPUT_BIT;
+    total += dt;
+    if (this->at(i - 1).dt_out & OUTPUT_BIT) on += dt;
+  }
+  if (total == 0) return NAN;
+  return 100.0f * (float) on / (float) total;
+}
+
+float ChannelHistory::on_time_hours_per_day() const {
+  if (this->count_ < 2) return NAN;
+  uint32_t sum = 0;
+  for (auto s : this->on_s_) sum += s;
+  return (float) sum / 3600.0f;
+}
+
+void ChannelHistory::roll_buckets(uint32_t now_ms) {
+  if (this->bucket_start_ms_ == 0) this->bucket_start_ms_ = now_ms;
+  while (now_ms - this->bucket_start_ms_ >= 3600000u) {
+    this->bucket_ = (uint8_t) ((this->bucket_ + 1) % 24);
+    this->on_s_[this->bucket_] = 0;
+    this->bucket_start_ms_ += 3600000u;
   }
 }
 
@@ -914,6 +2523,7 @@ climate::ClimateTraits WavinZoneClimate::traits() {
   return t;
 }
 void WavinZoneClimate::control(const climate::ClimateCall &call) {
+  this->parent_->begin_command();
   // Mode control
   if (call.get_mode().has_value()) {
     auto m = *call.get_mode();
@@ -992,9 +2602,51 @@ void WavinZoneClimate::control(const climate::ClimateCall &call) {
       this->parent_->write_channel_floor_max_temperature(this->single_channel_, new_hi);
     }
   }
+  this->parent_->end_command();
 
   this->publish_state();
 }
+void WavinZoneClimate::on_channel_change(uint8_t ch, uint16_t changed) {
+  this->dirty_ = true;
+  if (this->single_channel_set_) return;  // recomputed from the hub cache when published
+  auto pos = std::find(this->members_.begin(), this->members_.end(), ch);
+  if (pos == this->members_.end()) return;
+  if (this->contributions_.size() != this->members_.size()) this->contributions_.resize(this->members_.size());
+  auto &mine = this->contributions_[pos - this->members_.begin()];
+
+  // Swap this member's old contribution for the new one
+  auto to_cd = [](float c) { return (int32_t) std::lround(c * 100.0f); };
+  if (changed & CHANGE_TEMPERATURE) {
+    float c = this->parent_->get_channel_current_temp(ch);
+    if (mine.has_current) { this->sum_current_cd_ -= mine.current_cd; this->n_current_--; }
+    mine.has_current = !std::isnan(c);
+    if (mine.has_current) { mine.current_cd = to_cd(c); this->sum_current_cd_ += mine.current_cd; this->n_current_++; }
+  }
+  if (changed & CHANGE_SETPOINT) {
+    float s = this->parent_->get_channel_setpoint(ch);
+    if (mine.has_setpoint) { this->sum_setpoint_cd_ -= mine.setpoint_cd; this->n_setpoint_--; }
+    mine.has_setpoint = !std::isnan(s);
+    if (mine.has_setpoint) { mine.setpoint_cd = to_cd(s); this->sum_setpoint_cd_ += mine.setpoint_cd; this->n_setpoint_++; }
+  }
+  if (changed & CHANGE_ACTION) {
+    bool heating = this->parent_->get_channel_action(ch) == climate::CLIMATE_ACTION_HEATING;
+    this->n_heating_ = (uint8_t) (this->n_heating_ - mine.heating + heating);
+    mine.heating = heating;
+  }
+  if (changed & CHANGE_MODE) {
+    bool off = this->parent_->get_channel_mode(ch) == climate::CLIMATE_MODE_OFF;
+    this->n_off_ = (uint8_t) (this->n_off_ - mine.off + off);
+    mine.off = off;
+  }
+}
+
+bool WavinZoneClimate::publish_if_dirty() {
+  if (!this->dirty_) return false;
+  this->dirty_ = false;
+  this->update_from_parent();
+  return true;
+}
+
 void WavinZoneClimate::update_from_parent() {
   if (this->single_channel_set_) {
     uint8_t ch = this->single_channel_;
@@ -1027,23 +2679,10 @@ void WavinZoneClimate::update_from_parent() {
       this->action = raw_action;
     }
   } else if (!this->members_.empty()) {
-    float sum_curr = 0.0f, sum_set = 0.0f;
-    int n_curr = 0;
-    bool any_heat = false;
-    bool all_off = true;
-    for (auto ch : this->members_) {
-      float c = this->parent_->get_channel_current_temp(ch);
-      if (!std::isnan(c)) {
-        sum_curr += c;
-        n_curr++;
-      }
-      float s = this->parent_->get_channel_setpoint(ch);
-      if (!std::isnan(s)) sum_set += s;
-      if (this->parent_->get_channel_action(ch) == climate::CLIMATE_ACTION_HEATING) any_heat = true;
-      if (this->parent_->get_channel_mode(ch) != climate::CLIMATE_MODE_OFF) all_off = false;
-    }
-    if (n_curr > 0) this->current_temperature = sum_curr / n_curr;
-    if (!this->members_.empty()) this->target_temperature = sum_set / this->members_.size();
+    if (this->n_current_ > 0) this->current_temperature = this->sum_current_cd_ / (100.0f * this->n_current_);
+    if (this->n_setpoint_ > 0) this->target_temperature = this->sum_setpoint_cd_ / (100.0f * this->n_setpoint_);
+    bool any_heat = this->n_heating_ > 0;
+    bool all_off = this->n_off_ == this->members_.size();
     this->mode = all_off ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
     // Group action: prefer temperature comparison with deadband, fallback to any member heating
     const float db = 0.3f;
@@ -2,11 +2,28 @@
 
 #include "esphome/components/climate/climate.h"
 #include "esphome/components/uart/uart.h"
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+// Each entity platform of this component defines WAVIN_AHC9000_<PLATFORM> from its to_code(); only
+// those platforms' registries, publish paths and entity classes are compiled in
+#ifdef WAVIN_AHC9000_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+#ifdef WAVIN_AHC9000_BINARY_SENSOR
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#endif
+#ifdef WAVIN_AHC9000_TEXT_SENSOR
 #include "esphome/components/text_sensor/text_sensor.h"
+#endif
+#ifdef WAVIN_AHC9000_SWITCH
 #include "esphome/components/switch/switch.h"
+#endif
+#ifdef WAVIN_AHC9000_NUMBER
 #include "esphome/components/number/number.h"
-#include "esphome/components/binary_sensor/binary_sensor.h"
-#include "esphome/core/component.h"
+#endif
+#ifdef WAVIN_AHC9000_BUTTON
+#include "esphome/components/button/button.h"
+#endif
 
 #include <vector>
 #include <map>
@@ -14,19 +31,329 @@
 #include <cmath>
 #include <deque>
 #include <string>
+#include <algorithm>
+#include <functional>
+#ifdef WAVIN_AHC9000_IO_TASK
+#include <atomic>
+#ifndef USE_ESP32
+#include <thread>
+#endif
+#endif
 
 namespace esphome {
-namespace sensor { class Sensor; }
-namespace text_sensor { class TextSensor; }
-namespace switch_ { class Switch; }
-namespace binary_sensor { class BinarySensor; }
 namespace wavinahc9000v3 {
 
+// Channel capacity of the configured controller model (set from the `model:` option)
+#ifndef WAVIN_AHC9000_CHANNELS
+#define WAVIN_AHC9000_CHANNELS 16
+#endif
+static constexpr uint8_t MAX_CHANNELS = WAVIN_AHC9000_CHANNELS;
+
 // Forward declarations
 class WavinAHC9000;
 class WavinZoneClimate;
 class WavinSwitch;
 
+// Writable per-channel fields tracked by the desired-state reconciler (bitmask values)
+enum WavinField : uint8_t {
+  FIELD_SETPOINT = 1 << 0,
+  FIELD_STANDBY_SETPOINT = 1 << 1,
+  FIELD_MODE = 1 << 2,
+  FIELD_CHILD_LOCK = 1 << 3,
+  FIELD_HYSTERESIS = 1 << 4,
+  FIELD_FLOOR_MIN = 1 << 5,
+  FIELD_FLOOR_MAX = 1 << 6,
+};
+static constexpr uint8_t FIELD_COUNT = 7;
+
+// Change-notification bits; the writable fields reuse their WavinField values
+enum ChannelChange : uint16_t {
+  CHANGE_SETPOINT = FIELD_SETPOINT,
+  CHANGE_STANDBY_SETPOINT = FIELD_STANDBY_SETPOINT,
+  CHANGE_MODE = FIELD_MODE,
+  CHANGE_CHILD_LOCK = FIELD_CHILD_LOCK,
+  CHANGE_HYSTERESIS = FIELD_HYSTERESIS,
+  CHANGE_FLOOR_MIN = FIELD_FLOOR_MIN,
+  CHANGE_FLOOR_MAX = FIELD_FLOOR_MAX,
+  CHANGE_TEMPERATURE = 1 << 8,
+  CHANGE_FLOOR_TEMPERATURE = 1 << 9,
+  CHANGE_ACTION = 1 << 10,
+  CHANGE_ALL = 0xFFFF,
+};
+
+// Last value read back from the controller for one writable field (raw register units;
+// mode and child lock store 0/1)
+struct RegisterShadow {
+  uint16_t raw{0};
+  uint32_t read_ms{0}; // 0 = never read
+};
+
+// Simple cache per channel
+struct ChannelState {
+  float current_temp_c{NAN};
+  float floor_temp_c{NAN};
+  // New read-only floor limits (Celsius)
+  float floor_min_c{NAN};
+  float floor_max_c{NAN};
+  float setpoint_c{NAN};
+  float standby_setpoint_c{NAN};
+  climate::ClimateMode mode{climate::CLIMATE_MODE_HEAT};
+  climate::ClimateAction action{climate::CLIMATE_ACTION_OFF};
+  uint8_t battery_pct{255}; // 0..100; 255=unknown
+  float rssi_element_dbm{NAN}; // RSSI at element/thermostat side (dBm)
+  float rssi_cu_dbm{NAN}; // RSSI at control unit side (dBm)
+  float hysteresis_c{NAN}; // hysteresis (°C)
+  uint16_t primary_index{0};
+  bool all_tp_lost{false};
+  bool has_floor_sensor{false};
+  bool child_lock{false};
+  uint16_t raw_config{0}; // last PACKED_CONFIGURATION read (for reconciler RMW)
+  uint16_t raw_status{0}; // last CH_TIMER_EVENT read (change probe)
+  uint8_t read_fields{0}; // WavinField bits refreshed by the current read set
+  bool read_clean{false};  // current read set has had no failed transactions so far
+  uint32_t refreshed_ms{0}; // millis() when the last clean read set completed (0 = never)
+  RegisterShadow shadow[FIELD_COUNT]; // indexed by WavinField bit position
+  // Snapshot support: seq is odd while a read set of the channel is in progress (some fields
+  // already refreshed, others not), even once it completed. step_ms holds millis() of the last
+  // successful read of each read-set step: status/output, configuration, setpoints, floor limits, element.
+  uint32_t seq{0};
+  uint32_t step_ms[5]{};
+  bool is_consistent() const { return (this->seq & 1) == 0; }
+  // Time of the last successful read of the field behind a ChannelChange bit (0 = never)
+  uint32_t field_read_ms(uint16_t change) const {
+    if (change & (CHANGE_TEMPERATURE | CHANGE_FLOOR_TEMPERATURE)) return this->step_ms[4];
+    if (change & (CHANGE_FLOOR_MIN | CHANGE_FLOOR_MAX)) return this->step_ms[3];
+    if (change & (CHANGE_SETPOINT | CHANGE_STANDBY_SETPOINT | CHANGE_HYSTERESIS)) return this->step_ms[2];
+    if (change & (CHANGE_MODE | CHANGE_CHILD_LOCK)) return this->step_ms[1];
+    return this->step_ms[0];
+  }
+};
+
+// Declarative register map. Each Reg row names one decoded field: register index, decoder and the
+// ChannelState member it lands in (plus the WavinField bit it refreshes for the reconciler). Rows are
+// grouped into ReadSpan transactions (one FC_READ covering all rows of a category) and spans into
+// per-step ReadPlans. Everything is resolved at compile time: reading a plan unrolls to the
+// transactions and straight-line decode code, with no table lookups or virtual dispatch.
+// A newly reverse-engineered register is one more Reg row in the right span.
+namespace regmap {
+
+struct DecodeContext {
+  float temp_divisor;
+};
+
+// --- Decoders: static decode(raw, ctx) -> value assigned to the row's field ---
+struct Temperature {
+  static float decode(uint16_t raw, const DecodeContext &ctx) { return raw / ctx.temp_divisor; }
+};
+struct Tenths {
+  static float decode(uint16_t raw, const DecodeContext &) { return (float) raw / 10.0f; }
+};
+// Floor probe: values outside 1..90 °C mean no probe connected
+struct FloorProbe {
+  static float decode(uint16_t raw, const DecodeContext &ctx) {
+    float t = raw / ctx.temp_divisor;
+    return (t > 1.0f && t < 90.0f) ? t : NAN;
+  }
+};
+struct FloorProbePresent {
+  static bool decode(uint16_t raw, const DecodeContext &ctx) { return !std::isnan(FloorProbe::decode(raw, ctx)); }
+};
+// Battery: 0..10 steps of 10 %
+struct BatterySteps {
+  static uint8_t decode(uint16_t raw, const DecodeContext &) { return (uint8_t) ((raw > 10 ? 10 : raw) * 10); }
+};
+// RSSI byte: raw value 0x00 = -74 dBm, each step is +0.5 dBm, treated as signed 8-bit
+template<uint8_t Shift> struct RssiByte {
+  static float decode(uint16_t raw, const DecodeContext &) { return -74.0f + ((int8_t) ((raw >> Shift) & 0xFF) * 0.5f); }
+};
+template<uint16_t Mask> struct Bits {
+  static uint16_t decode(uint16_t raw, const DecodeContext &) { return raw & Mask; }
+};
+template<uint16_t Mask> struct Flag {
+  static bool decode(uint16_t raw, const DecodeContext &) { return (raw & Mask) != 0; }
+};
+template<uint16_t Mask, uint16_t Standby, uint16_t StandbyAlt> struct Mode {
+  static climate::ClimateMode decode(uint16_t raw, const DecodeContext &) {
+    uint16_t bits = raw & Mask;
+    return (bits == Standby || bits == StandbyAlt) ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
+  }
+};
+template<uint16_t OutputMask> struct OutputAction {
+  static climate::ClimateAction decode(uint16_t raw, const DecodeContext &) {
+    return (raw & OutputMask) ? climate::CLIMATE_ACTION_HEATING : climate::CLIMATE_ACTION_IDLE;
+  }
+};
+
+// --- Table building blocks ---
+template<uint8_t Index, typename Decoder, auto Field, uint8_t Fresh = 0> struct Reg {
+  static constexpr uint8_t INDEX = Index;
+  static constexpr uint8_t FRESH = Fresh;
+  static void apply(const uint16_t *span, uint8_t start, const DecodeContext &ctx, ChannelState &st) {
+    st.*Field = Decoder::decode(span[Index - start], ctx);
+  }
+};
+
+template<uint8_t Category, typename... Rows> struct ReadSpan {
+  static_assert(sizeof...(Rows) > 0, "ReadSpan needs at least one row");
+  static constexpr uint8_t CATEGORY = Category;
+  static constexpr uint8_t START = std::min({Rows::INDEX...});
+  static constexpr uint8_t COUNT = (uint8_t) (std::max({Rows::INDEX...}) - START + 1);
+  static constexpr uint8_t FRESH = (uint8_t) (0 | ... | Rows::FRESH);
+  static void decode(const uint16_t *span, const DecodeContext &ctx, ChannelState &st) {
+    (Rows::apply(span, START, ctx, st), ...);
+  }
+};
+
+template<typename... Spans> struct ReadPlan {
+  static constexpr uint8_t TRANSACTIONS = sizeof...(Spans);
+  static constexpr uint16_t REGISTERS = (uint16_t) (0 + ... + Spans::COUNT);
+};
+
+}  // namespace regmap
+
+// Compact per-channel history over a sliding window. Air/floor temperatures are stored as int8 deltas
+// in 0.1 °C steps against a running value (base = value of the oldest sample), the time step in
+// seconds shares a word with the output bit: 4 bytes per sample.
+class ChannelHistory {
+ public:
+  void init(uint16_t capacity, uint32_t window_ms);
+  bool is_initialized() const { return !this->ring_.empty(); }
+  void add(uint32_t now_ms, float air_c, float floor_c, bool output);
+  float air_trend_c_per_hour() const { return this->trend_c_per_hour(false); }
+  float floor_trend_c_per_hour() const { return this->trend_c_per_hour(true); }
+  float duty_cycle_pct() const;
+  // Output on-time over the last 24 h (hourly buckets)
+  float on_time_hours_per_day() const;
+
+ protected:
+  struct Sample {
+    uint16_t dt_out;  // bits 0..14: seconds since previous sample, bit 15: output on
+    int8_t d_air;     // DELTA_MISSING if no value
+    int8_t d_floor;
+  };
+  static constexpr int8_t DELTA_MISSING = -128;
+  static constexpr uint16_t OUTPUT_BIT = 0x8000;
+  const Sample &at(uint16_t i) const { return this->ring_[(this->head_ + i) % this->ring_.size()]; }
+  void evict_oldest();
+  float trend_c_per_hour(bool floor) const;
+  void roll_buckets(uint32_t now_ms);
+
+  std::vector<Sample> ring_;
+  uint16_t head_{0};
+  uint16_t count_{0};
+  uint32_t window_ms_{0};
+  uint32_t base_ms_{0}; // timestamp of the oldest sample
+  uint32_t last_ms_{0};
+  int16_t base_air_{0}, base_floor_{0}; // decidegrees at the oldest sample
+  int16_t run_air_{0}, run_floor_{0};   // decidegrees at the newest sample
+  bool air_known_{false}, floor_known_{false};
+  uint16_t on_s_[24] = {0};             // output on-seconds per hour bucket
+  uint8_t bucket_{0};
+  uint32_t bucket_start_ms_{0};
+};
+
+// Fixed-size binary capture of raw bus frames for field diagnostics. Records are stored back to back
+// in a byte ring ([len][flags][t_us x4][bytes...]); the oldest records are dropped when full.
+// Capacity 0 disables capture (one branch per frame).
+class BusTrace {
+ public:
+  enum Flags : uint8_t {
+    DIR_TX = 0x00,
+    DIR_RX = 0x01,
+    OUTCOME_OK = 0x00,
+    OUTCOME_TIMEOUT = 0x02,
+    OUTCOME_CRC = 0x04,
+  };
+  void init(size_t capacity) { this->buf_.assign(capacity, 0); this->head_ = this->used_ = 0; }
+  bool enabled() const { return !this->buf_.empty(); }
+  void record(uint8_t flags, const uint8_t *data, size_t len) {
+    if (this->buf_.empty()) return;
+    this->append(flags, data, len);
+  }
+  // Logs every record as compact hex lines (long frames wrap); returns the number of records
+  size_t dump(const char *tag) const;
+  void clear() { this->head_ = this->used_ = 0; }
+
+ protected:
+  static constexpr size_t HEADER = 6;
+  void append(uint8_t flags, const uint8_t *data, size_t len);
+  uint8_t at(size_t offset) const { return this->buf_[(this->head_ + offset) % this->buf_.size()]; }
+  void put(size_t offset, uint8_t b) { this->buf_[(this->head_ + offset) % this->buf_.size()] = b; }
+
+  std::vector<uint8_t> buf_;
+  size_t head_{0}; // offset of the oldest record
+  size_t used_{0};
+};
+
+// Bus work accounting for one sweep (every active channel read once)
+struct SweepStats {
+  uint32_t transactions{0};
+  uint32_t timeouts{0};
+  uint32_t crc_errors{0};
+  uint32_t tx_bytes{0};
+  uint32_t rx_bytes{0};
+  uint32_t bus_us{0};  // time spent between request TX and response (or timeout)
+  uint32_t wall_ms{0}; // sweep start to completion
+  uint32_t max_data_age_ms{0}; // oldest clean read among active channels at sweep completion
+  uint32_t max_loop_us{0};     // longest single loop() call during the sweep
+  uint32_t writes_elided{0};   // writes answered from the register shadow
+  uint32_t probe_sets{0};      // read sets cut short by an unchanged probe (probe sweep mode)
+  uint32_t full_sets{0};       // complete read sets
+  uint32_t element_skips{0};   // element block reads skipped, no report expected since the last one
+  uint32_t element_reads{0};   // element-only reads scheduled just after an expected report
+  // Adds the per-transaction counters (all an I/O task result carries)
+  void add_bus_counters(const SweepStats &o) {
+    this->transactions += o.transactions;
+    this->timeouts += o.timeouts;
+    this->crc_errors += o.crc_errors;
+    this->tx_bytes += o.tx_bytes;
+    this->rx_bytes += o.rx_bytes;
+    this->bus_us += o.bus_us;
+  }
+};
+
+#ifdef WAVIN_AHC9000_FAULT_INJECTION
+// Bus impairments applied to the receive path for soak testing against a degraded bus.
+// Per-frame faults are decided when a request goes out, per-byte faults as bytes arrive.
+struct FaultProfile {
+  float drop_rate{0.0f};     // probability a received byte is lost
+  float bit_flip_rate{0.0f}; // probability a received byte has one bit inverted
+  float truncate_rate{0.0f}; // probability a response is cut short
+  float silence_rate{0.0f};  // probability a response never arrives
+  uint32_t latency_ms{0};    // extra delay before the first response byte is visible
+  bool tx_echo{false};       // feed the request back into RX first (half-duplex echo)
+};
+#endif
+
+#ifdef WAVIN_AHC9000_IO_TASK
+// Bounded ring between exactly one producer thread and one consumer thread. Each index is written
+// by one side only; release/acquire on the indices publishes the slot contents. Holds N - 1 items.
+template<typename T, uint8_t N> class SpscQueue {
+ public:
+  bool push(const T &item) {
+    uint8_t head = this->head_.load(std::memory_order_relaxed);
+    uint8_t next = (uint8_t) ((head + 1) % N);
+    if (next == this->tail_.load(std::memory_order_acquire)) return false;  // full
+    this->items_[head] = item;
+    this->head_.store(next, std::memory_order_release);
+    return true;
+  }
+  bool pop(T &item) {
+    uint8_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail == this->head_.load(std::memory_order_acquire)) return false;  // empty
+    item = this->items_[tail];
+    this->tail_.store((uint8_t) ((tail + 1) % N), std::memory_order_release);
+    return true;
+  }
+
+ protected:
+  std::atomic<uint8_t> head_{0};
+  std::atomic<uint8_t> tail_{0};
+  T items_[N];
+};
+#endif
+
+#ifdef WAVIN_AHC9000_NUMBER
 class WavinSetpointNumber : public number::Number {
  public:
   static constexpr uint8_t COMFORT = 0;
@@ -45,6 +372,7 @@ class WavinSetpointNumber : public number::Number {
   uint8_t channel_{0};
   uint8_t type_{COMFORT};
 };
+#endif
 
 class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
  public:
@@ -53,8 +381,50 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   void set_tx_enable_pin(GPIOPin *p) { this->tx_enable_pin_ = p; }
   // Optional half-duplex RS485 DE/RE (flow control) pin. If provided we drive HIGH to transmit and LOW to receive.
   void set_flow_control_pin(GPIOPin *p) { this->flow_control_pin_ = p; }
-  void set_poll_channels_per_cycle(uint8_t n) { this->poll_channels_per_cycle_ = n == 0 ? 1 : (n > 16 ? 16 : n); }
+  void set_poll_channels_per_cycle(uint8_t n) { this->poll_channels_per_cycle_ = n == 0 ? 1 : (n > MAX_CHANNELS ? MAX_CHANNELS : n); }
+  // Target refresh interval for one channel; the shortest request wins when several entities ask.
+  // Channels without one get the round-robin period implied by update_interval / poll_channels_per_cycle.
+  void set_channel_refresh_interval(uint8_t ch, uint32_t ms);
   void set_allow_mode_writes(bool v) { this->allow_mode_writes_ = v; }
+  // Rate cap for entity publishes (spread over loop() iterations)
+  void set_max_publishes_per_second(uint16_t n);
+  // Per entity-class publish filter: min change, heartbeat (0 = none) and min spacing between publishes
+  enum PublishPolicyClass : uint8_t {
+    POLICY_TEMPERATURE = 0, // air and floor temperature
+    POLICY_SETPOINT = 1,    // setpoints, floor limits, hysteresis (sensors and numbers)
+    POLICY_RSSI = 2,
+    POLICY_BATTERY = 3,
+    POLICY_STATE = 4,       // switches and binary sensors
+    POLICY_STATISTICS = 5,  // duty cycle and on-time derived from history
+    POLICY_TREND = 6,       // temperature rates of change (°C/h) derived from history
+    POLICY_COUNT = 7,
+  };
+  void set_publish_policy(uint8_t cls, float min_delta, uint32_t heartbeat_ms, uint32_t min_interval_ms);
+  // Paced per-channel publishing, triggered when a channel's read set completes
+  enum PublishKind : uint8_t {
+    PUB_CLIMATE = 0,
+    PUB_GROUP_CLIMATE,
+    PUB_TEMPERATURE,
+    PUB_FLOOR_TEMPERATURE,
+    PUB_BATTERY,
+    PUB_COMFORT_SETPOINT,
+    PUB_FLOOR_MIN,
+    PUB_FLOOR_MAX,
+    PUB_RSSI_ELEMENT,
+    PUB_RSSI_CU,
+    PUB_COMFORT_NUMBER,
+    PUB_STANDBY_NUMBER,
+    PUB_HYSTERESIS_NUMBER,
+    PUB_CHILD_LOCK,
+    PUB_STANDBY_SWITCH,
+    PUB_OUTPUT,
+    PUB_PROBLEM,
+    PUB_TEMPERATURE_TREND,
+    PUB_FLOOR_TEMPERATURE_TREND,
+    PUB_DUTY_CYCLE,
+    PUB_ON_TIME,
+    PUB_COUNT,
+  };
   bool get_allow_mode_writes() const { return this->allow_mode_writes_; }
   // Friendly name support (optional per-channel overrides for generated YAML)
   void set_channel_friendly_name(uint8_t channel, const std::string &name);
@@ -67,6 +437,11 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
 
   void add_channel_climate(WavinZoneClimate *c);
   void add_group_climate(WavinZoneClimate *c);
+  // Change notification: the listener runs when a read set of the channel completes and any of the
+  // watched ChannelChange bits differ from what was last notified; `changed` holds those bits.
+  using ChannelListener = std::function<void(uint8_t channel, uint16_t changed)>;
+  void subscribe_channel(uint8_t channel, uint16_t fields, ChannelListener listener);
+#ifdef WAVIN_AHC9000_SENSOR
   void add_channel_battery_sensor(uint8_t ch, sensor::Sensor *s);
   void add_channel_temperature_sensor(uint8_t ch, sensor::Sensor *s);
   void add_channel_comfort_setpoint_sensor(uint8_t ch, sensor::Sensor *s);
@@ -76,18 +451,51 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   void add_channel_floor_max_temperature_sensor(uint8_t ch, sensor::Sensor *s);
   void add_channel_rssi_element_sensor(uint8_t ch, sensor::Sensor *s);
   void add_channel_rssi_cu_sensor(uint8_t ch, sensor::Sensor *s);
+  // Derived from on-device history (see ChannelHistory)
+  void add_channel_temperature_trend_sensor(uint8_t ch, sensor::Sensor *s);
+  void add_channel_floor_temperature_trend_sensor(uint8_t ch, sensor::Sensor *s);
+  void add_channel_duty_cycle_sensor(uint8_t ch, sensor::Sensor *s);
+  void add_channel_on_time_sensor(uint8_t ch, sensor::Sensor *s);
+#endif
+  void set_history_window_ms(uint32_t ms) { this->history_window_ms_ = ms; }
+  void set_history_samples(uint16_t n) { this->history_samples_ = n < 2 ? 2 : n; }
+#ifdef WAVIN_AHC9000_NUMBER
   void add_comfort_number(number::Number *n);
   void add_standby_number(number::Number *n);
   void add_hysteresis_number(number::Number *n);
+#endif
+#ifdef WAVIN_AHC9000_SWITCH
   void add_channel_child_lock_switch(uint8_t ch, switch_::Switch *s) { this->child_lock_switches_[ch] = s; }
   void add_channel_standby_switch(uint8_t ch, switch_::Switch *s) { this->standby_switches_[ch] = s; }
+#endif
+#ifdef WAVIN_AHC9000_BINARY_SENSOR
   void add_channel_output_binary_sensor(uint8_t ch, binary_sensor::BinarySensor *s) { this->output_binary_sensors_[ch] = s; }
   void add_channel_problem_binary_sensor(uint8_t ch, binary_sensor::BinarySensor *s) { this->problem_binary_sensors_[ch] = s; }
+#endif
   void add_active_channel(uint8_t ch);
 
   // Send commands
   void write_channel_setpoint(uint8_t channel, float celsius);
   void write_group_setpoint(const std::vector<uint8_t> &members, float celsius);
+  // Entity handlers bracket their write_* calls with these, so a command's latency (and its queue
+  // stage) counts from the moment the handler received it rather than from the write call
+  void begin_command() { this->command_issued_ms_ = millis(); }
+  void end_command() { this->command_issued_ms_ = 0; }
+  // Scenes: a batch of changes across channels. All writes go out ahead of any verification read,
+  // each channel is verified once (only the spans holding the changed fields) and the outcome is
+  // reported per channel to the scene callbacks. Returns the scene id.
+  struct SceneChange {
+    uint8_t channel;
+    uint8_t field;  // WavinField
+    float value;    // °C for temperatures; mode 0 = off, else heat; child lock 0/1
+  };
+  using SceneResultCallback = std::function<void(uint32_t scene, uint8_t channel, bool ok)>;
+  uint32_t apply_scene(const std::vector<SceneChange> &changes);
+  // API service form: parallel arrays; fields are setpoint, standby_setpoint, mode, child_lock,
+  // hysteresis, floor_min, floor_max
+  uint32_t apply_scene(const std::vector<int32_t> &channels, const std::vector<std::string> &fields,
+                       const std::vector<float> &values);
+  void add_on_scene_result_callback(SceneResultCallback cb) { this->scene_callbacks_.push_back(std::move(cb)); }
   void write_channel_standby_setpoint(uint8_t channel, float celsius);
   void write_channel_mode(uint8_t channel, climate::ClimateMode mode);
   void write_channel_child_lock(uint8_t channel, bool enable);
@@ -95,15 +503,67 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   void write_channel_floor_min_temperature(uint8_t channel, float celsius);
   void write_channel_floor_max_temperature(uint8_t channel, float celsius);
   void write_channel_hysteresis(uint8_t channel, float celsius);
+  // Full re-read of every span ahead of discovery and routine polling, also while a write is unconfirmed
   void refresh_channel_now(uint8_t channel);
+  // Raw bus trace (bus_trace_size bytes, 0 = off); dump is meant for a button or an API service lambda
+  void set_bus_trace_size(uint32_t bytes) { this->bus_trace_.init(bytes); }
+  void dump_bus_trace();
+  // Background read of every register area (commissioning aid); chunks go to the log and the
+  // optional register_dump text sensor. Runs only when no channel work is queued.
+  void start_register_dump();
+#ifdef WAVIN_AHC9000_TEXT_SENSOR
+  void set_register_dump_sensor(text_sensor::TextSensor *s) { this->register_dump_sensor_ = s; }
+#endif
+  // Accounting of the last completed sweep, for regression comparisons from logs or lambdas
+  const SweepStats &get_last_sweep_stats() const { return this->last_sweep_; }
+  // Command latency (issue -> confirmed and published), over the last LATENCY_WINDOW commands
+#ifdef WAVIN_AHC9000_SENSOR
+  void set_command_latency_p50_sensor(sensor::Sensor *s) { this->latency_p50_sensor_ = s; }
+  void set_command_latency_p95_sensor(sensor::Sensor *s) { this->latency_p95_sensor_ = s; }
+#endif
+  void set_slow_command_threshold_ms(uint32_t ms) { this->slow_command_ms_ = ms; }
+  // Per-transaction tracing; only has an effect when compiled in with bus_log_level: DEBUG
+  void set_bus_tracing(bool enable) { this->bus_tracing_ = enable; }
+  bool is_bus_tracing() const { return this->bus_tracing_; }
+  // Writes whose target matches a read no older than this are skipped (0 disables elision)
+  void set_write_elision_max_age_ms(uint32_t ms) { this->write_elision_max_age_ms_ = ms; }
+  uint32_t get_writes_elided() const { return this->writes_elided_; }
+  // Probe sweep: routine polls read only channel status and the element block, and run the full
+  // read set when the status word or primary element changed, after a write, or once the last full
+  // read is older than full_read_interval
+  void set_probe_sweep(bool enable) { this->probe_sweep_ = enable; }
+  void set_full_read_interval_ms(uint32_t ms) { this->full_read_interval_ms_ = ms; }
+  // Element phase polling: learn each wireless element's reporting period and phase from changes
+  // in its block, read the block just after the expected report and skip it in between
+  void set_element_phase_polling(bool enable) { this->element_phase_polling_ = enable; }
+  // Controller identity check (CAT_INFO) every interval and after a failing read set; 0 keeps only the
+  // failure-triggered checks. A new identity or an answer after an outage triggers a resync.
+  void set_identity_check_interval_ms(uint32_t ms) { this->identity_check_interval_ms_ = ms; }
+  uint32_t get_resync_count() const { return this->resyncs_; }
+#ifdef WAVIN_AHC9000_IO_TASK
+  // Run the UART and transaction engine in a dedicated task (ESP32) or thread (host), see start_io_task()
+  void set_io_task(bool enable) { this->io_task_enabled_ = enable; }
+  bool is_io_task_running() const { return this->io_running_; }
+  // Stops the I/O task after its current transaction and hands the UART back to the main loop. On
+  // ESP32 the wait is bounded; a task that does not stop in time is left running (and logged).
+  void stop_io_task();
+  void on_shutdown() override { this->stop_io_task(); }
+  ~WavinAHC9000() override { this->stop_io_task(); }
+#endif
+#ifdef WAVIN_AHC9000_FAULT_INJECTION
+  void set_fault_profile(const FaultProfile &profile) { this->fault_ = profile; }
+  FaultProfile &get_fault_profile() { return this->fault_; }
+#endif
   void set_strict_mode_write(uint8_t channel, bool enable);
   bool is_strict_mode_write(uint8_t channel) const;
   void request_status();
   void request_status_channel(uint8_t ch_index);
   void normalize_channel_config(uint8_t channel, bool off);
+#ifdef WAVIN_AHC9000_TEXT_SENSOR
   void set_software_version_sensor(text_sensor::TextSensor *s) { this->software_version_sensor_ = s; }
   void set_hardware_version_sensor(text_sensor::TextSensor *s) { this->hardware_version_sensor_ = s; }
   void set_device_name_sensor(text_sensor::TextSensor *s) { this->device_name_sensor_ = s; }
+#endif
   bool is_channel_child_locked(uint8_t ch) const {
     auto it = this->channels_.find(ch);
     if (it == this->channels_.end()) return false;
@@ -111,6 +571,16 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   }
 
   // Data access
+  // Whole-house view without copying: a const reference to the channel cache plus a sequence number
+  // that advances with every completed read set or applied write. Lambdas run between bus steps, so
+  // the view cannot change while one executes; a channel whose ChannelState::is_consistent() is false
+  // was caught between two steps of its read set. Keep seq to detect changes between lambda runs.
+  struct StateView {
+    const std::map<uint8_t, ChannelState> &channels;
+    uint32_t seq;
+  };
+  StateView get_state_view() const { return StateView{this->channels_, this->state_seq_}; }
+  uint32_t get_state_seq() const { return this->state_seq_; }
   float get_channel_current_temp(uint8_t channel) const;
   float get_channel_setpoint(uint8_t channel) const;
   float get_channel_floor_temp(uint8_t channel) const;
@@ -120,44 +590,167 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   climate::ClimateAction get_channel_action(uint8_t channel) const;
 
  protected:
-  // Low-level protocol helpers (dkjonas framing)
+  // Low-level protocol helpers (dkjonas framing). These are the entry points for the rest of the hub;
+  // the exec_* variants run the transaction on the bus owner (inline, or the I/O task when enabled).
   bool read_registers(uint8_t category, uint8_t page, uint8_t index, uint8_t count, std::vector<uint16_t> &out);
   bool write_register(uint8_t category, uint8_t page, uint8_t index, uint16_t value);
+  // Consecutive registers in one FC_WRITE (count up to WRITE_MAX_REGS). Falls back to single writes
+  // while the controller has not shown it applies every register of a multi-register write.
+  bool write_registers(uint8_t category, uint8_t page, uint8_t index, const uint16_t *values, uint8_t count);
   // Masked write: apply (reg & and_mask) | or_mask semantics
   bool write_masked_register(uint8_t category, uint8_t page, uint8_t index, uint16_t and_mask, uint16_t or_mask);
-  void query_device_info();
+  bool exec_read(uint8_t category, uint8_t page, uint8_t index, uint8_t count, std::vector<uint16_t> &out);
+  bool exec_write(uint8_t category, uint8_t page, uint8_t index, const uint16_t *values, uint8_t count);
+  bool exec_write_masked(uint8_t category, uint8_t page, uint8_t index, uint16_t and_mask, uint16_t or_mask);
+  bool dispatch_write(uint8_t category, uint8_t page, uint8_t index, const uint16_t *values, uint8_t count);
+  static constexpr uint8_t WRITE_MAX_REGS = 4;
+  // Firmware support for count > 1 on FC_WRITE, learned from the read-back of the first multi-write
+  enum MultiWriteSupport : uint8_t { MULTI_WRITE_UNKNOWN, MULTI_WRITE_SUPPORTED, MULTI_WRITE_UNSUPPORTED };
+  MultiWriteSupport multi_write_{MULTI_WRITE_UNKNOWN};
+  // One register of a write batch and the WavinField bits it carries
+  struct PendingWrite {
+    uint8_t index;
+    uint16_t value;
+    uint8_t fields;
+  };
+  // Writes a batch to one PACKED page, merging runs of adjacent registers; returns the acknowledged fields
+  uint8_t write_batch(uint8_t page, PendingWrite *writes, uint8_t count);
+  // One PRIO_WRITE job. prepare_write_job() builds it from the desired state on the main loop,
+  // run_write_job() does the bus part (inline or on the I/O task) and finish_write_job() applies
+  // the outcome back on the main loop. Mode and child lock are a read-modify-write of the
+  // configuration register unless config_exact carries the whole value (normalize).
+  struct WriteJob {
+    uint8_t channel{0};
+    uint8_t todo{0};  // WavinField bits covered
+    uint8_t count{0};
+    PendingWrite writes[FIELD_COUNT];
+    uint8_t config_fields{0};
+    uint16_t config_and{0xFFFF};
+    uint16_t config_or{0};
+    bool config_exact{false};
+    bool config_strict{false};  // on a failed configuration read, write config_strict_value instead
+    uint16_t config_strict_value{0};
+    climate::ClimateMode mode{climate::CLIMATE_MODE_HEAT};
+    bool child_lock{false};
+    bool relearn_multi_write{false};
+    // Outcome
+    uint8_t acked{0};
+    bool config_read{false};
+    uint16_t config_from{0};
+    uint16_t config_to{0};
+    MultiWriteSupport multi_write_before{MULTI_WRITE_UNKNOWN};
+    MultiWriteSupport multi_write_after{MULTI_WRITE_UNKNOWN};
+  };
+  WriteJob write_job_;  // at most one write job is in flight
+  bool multi_write_relearn_{false};  // set on the main loop, applied by the next write job
+  bool prepare_write_job(uint8_t channel, WriteJob &job);
+  void run_write_job(WriteJob &job);
+  void finish_write_job(const WriteJob &job);
+  // Framing shared by the transactions above
+  enum RxResult : uint8_t { RX_OK, RX_TIMEOUT, RX_CRC };
+  static constexpr size_t RX_BUFFER_SIZE = 260;
+  void send_frame(uint8_t *msg, size_t len);
+  RxResult receive_frame(uint8_t function, uint8_t *buf, size_t &buf_len);
+  // Next received byte or -1; the single point where fault injection touches the RX stream
+  int read_rx_byte();
+  // Controller identity: reads the CAT_INFO version and name registers, detects a swapped or rebooted
+  // controller and publishes the device info text sensors when the identity is first seen or changes
+  void check_controller_identity();
+  void publish_device_info();
+  // Drops everything cached from the controller and queues every channel for a fresh read
+  void resync_controller(const char *reason);
+  void run_bus_job();
+  // Bookkeeping once a channel's read set completed (publish, history, verification)
+  void finish_read_set(uint8_t ch_num, uint8_t prio, uint8_t only);
 
-  void publish_updates();
-  bool process_channel_step(uint8_t ch_num, uint8_t &step);
+  void queue_publish(uint8_t ch);
+  void drain_publish_queue();
+  bool publish_channel_entity(uint8_t ch, uint8_t kind);
+  bool publish_allowed(uint8_t ch, uint8_t kind, float value);
+  // Queues the channels of changes held back by min_interval once their interval is over
+  void flush_held_publishes();
+  void forget_published(uint8_t ch);
+  bool process_channel_step(uint8_t ch_num, uint8_t &step, uint8_t only = 0, bool probe = false);
+  // Writable fields decoded by each step of the read set (status/output, configuration, setpoints,
+  // floor limits, element)
+  static constexpr uint8_t STEP_COUNT = 5;
+  // ONLY_ELEMENT is a pseudo field past the WavinField bits: an element-only read
+  static constexpr uint8_t ONLY_ELEMENT = 1 << 7;
+  static constexpr uint8_t STEP_FIELDS[STEP_COUNT] = {
+      0, FIELD_MODE | FIELD_CHILD_LOCK, FIELD_SETPOINT | FIELD_STANDBY_SETPOINT | FIELD_HYSTERESIS,
+      FIELD_FLOOR_MIN | FIELD_FLOOR_MAX, ONLY_ELEMENT};
+  // Read every span of a plan for one page; returns the number of spans read successfully
+  template<typename... Spans> uint8_t read_plan(regmap::ReadPlan<Spans...> /*plan*/, uint8_t page, ChannelState &st) {
+    return (uint8_t) (0 + ... + (this->read_span<Spans>(page, st) ? 1 : 0));
+  }
+  template<typename Span> bool read_span(uint8_t page, ChannelState &st) {
+    std::vector<uint16_t> regs;
+    if (!this->read_registers(Span::CATEGORY, page, Span::START, Span::COUNT, regs) || regs.size() < Span::COUNT)
+      return false;
+    Span::decode(regs.data(), regmap::DecodeContext{this->temp_divisor_}, st);
+    st.read_fields |= Span::FRESH;
+    return true;
+  }
 
   // Helpers
   float raw_to_c(float raw) const { return raw / this->temp_divisor_; }
   uint16_t c_to_raw(float c) const { return static_cast<uint16_t>(c * this->temp_divisor_ + 0.5f); }
 
-  // Simple cache per channel
-  struct ChannelState {
-    float current_temp_c{NAN};
-    float floor_temp_c{NAN};
-    // New read-only floor limits (Celsius)
-    float floor_min_c{NAN};
-    float floor_max_c{NAN};
-    float setpoint_c{NAN};
-    float standby_setpoint_c{NAN};
+  // Target values for writable fields; compared against each completed read set and rewritten until
+  // the controller reports them back (or RECONCILE_MAX_ATTEMPTS corrections have been tried).
+  struct DesiredState {
+    uint8_t pending{0}; // WavinField bits not yet confirmed
+    uint8_t unsent{0};  // WavinField bits queued for the next PRIO_WRITE job
+    uint16_t setpoint_raw{0};
+    uint16_t standby_raw{0};
+    uint16_t hysteresis_raw{0};
+    uint16_t floor_min_raw{0};
+    uint16_t floor_max_raw{0};
     climate::ClimateMode mode{climate::CLIMATE_MODE_HEAT};
-    climate::ClimateAction action{climate::CLIMATE_ACTION_OFF};
-    uint8_t battery_pct{255}; // 0..100; 255=unknown
-    float rssi_element_dbm{NAN}; // RSSI at element/thermostat side (dBm)
-    float rssi_cu_dbm{NAN}; // RSSI at control unit side (dBm)
-    float hysteresis_c{NAN}; // hysteresis (°C)
-    uint16_t primary_index{0};
-    bool all_tp_lost{false};
-    bool has_floor_sensor{false};
     bool child_lock{false};
+    bool config_exact{false};  // normalize: write config_exact_raw as is instead of read-modify-write
+    uint16_t config_exact_raw{0};
+    uint8_t attempts{0};
+    uint32_t since_ms{0};  // command issued (first change of this change set)
+    // Command latency tracking
+    uint32_t command_id{0};
+    uint32_t sent_ms{0};   // first write job started
+    uint32_t acked_ms{0};  // last write job finished
   };
+  DesiredState &desire(uint8_t channel);
+  bool reconcile_channel(uint8_t ch_num);
+  void apply_pending_writes(uint8_t channel);
+
+  // Bus work queues, served highest priority first by loop()
+  enum BusPriority : uint8_t {
+    PRIO_WRITE = 0,     // user commands
+    PRIO_VERIFY = 1,    // read-back after writes / explicit refresh
+    PRIO_DISCOVERY = 2, // device info and first read of each channel
+    PRIO_ROUTINE = 3,   // round-robin polling from update()
+    PRIO_COUNT = 4,
+  };
+  // full: the job must read every span, even a verification with fields pending (see full_read_due_)
+  void enqueue_channel(uint8_t ch, uint8_t prio, bool full = false);
 
   std::map<uint8_t, ChannelState> channels_;
   std::vector<WavinZoneClimate *> single_ch_climates_;
   std::vector<WavinZoneClimate *> group_climates_;
+  // Values as of the last notification, per channel; erased to force a full notification
+  struct ChannelSnapshot {
+    float current_c, floor_c, setpoint_c, standby_c, hysteresis_c, floor_min_c, floor_max_c;
+    climate::ClimateMode mode;
+    climate::ClimateAction action;
+    bool child_lock;
+  };
+  struct Subscription {
+    uint8_t channel;
+    uint16_t fields;
+    ChannelListener listener;
+  };
+  std::vector<Subscription> subscriptions_;
+  std::map<uint8_t, ChannelSnapshot> notified_;
+  void notify_changes(uint8_t ch);
+#ifdef WAVIN_AHC9000_SENSOR
   std::map<uint8_t, sensor::Sensor *> battery_sensors_;
   std::map<uint8_t, sensor::Sensor *> temperature_sensors_;
   std::map<uint8_t, sensor::Sensor *> floor_temperature_sensors_;
@@ -166,21 +759,225 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   std::map<uint8_t, sensor::Sensor *> floor_max_temperature_sensors_;
   std::map<uint8_t, sensor::Sensor *> rssi_element_sensors_;
   std::map<uint8_t, sensor::Sensor *> rssi_cu_sensors_;
+  std::map<uint8_t, sensor::Sensor *> temperature_trend_sensors_;
+  std::map<uint8_t, sensor::Sensor *> floor_temperature_trend_sensors_;
+  std::map<uint8_t, sensor::Sensor *> duty_cycle_sensors_;
+  std::map<uint8_t, sensor::Sensor *> on_time_sensors_;
+  std::map<uint8_t, sensor::Sensor *> comfort_setpoint_sensors_;
+  std::map<uint8_t, ChannelHistory> histories_; // only channels with a derived sensor
+#endif
+  BusTrace bus_trace_;
+  SweepStats sweep_;
+  SweepStats last_sweep_;
+  uint32_t sweep_start_ms_{0};
+  uint8_t sweep_channels_done_{0};
+  uint32_t tx_start_us_{0};
+  // Transaction counters land here: sweep_ itself, or the I/O task's own copy that travels back with
+  // each result (the main loop owns sweep_)
+  SweepStats *io_stats_{&sweep_};
+  void account_read_set();
+  void log_bus_trace();
+  bool bus_tracing_{true};
+  // Rate-limited bus fault warnings, counted per kind and category (category & 7)
+  enum BusFaultKind : uint8_t { BUS_FAULT_TIMEOUT, BUS_FAULT_CRC, BUS_FAULT_KIND_COUNT };
+  static constexpr uint32_t FAULT_SUMMARY_WINDOW_MS = 60000;
+  bool note_bus_fault(uint8_t kind, uint8_t category);
+  bool count_bus_fault(uint8_t kind, uint8_t category);
+  void flush_fault_summary();
+  void check_fault_summary();
+  uint16_t fault_counts_[BUS_FAULT_KIND_COUNT][8] = {};
+  uint32_t fault_window_start_ms_{0};
+  bool fault_window_open_{false};
+  // Register dump job state; one transaction per idle loop() call
+  struct RegisterDump {
+    bool active{false};
+    uint8_t area{0};
+    uint8_t page{0};
+    uint8_t index{0};
+    uint8_t span{0};   // registers requested per read; halved when the controller rejects a span
+    uint8_t limit{0};  // registers per page in the current area (learned block end once known)
+    bool limit_known{false};
+    uint16_t registers{0};
+    uint16_t skipped{0};
+    uint16_t transactions{0};
+    uint32_t start_ms{0};
+  };
+  RegisterDump dump_;
+  std::vector<uint16_t> dump_regs_;
+#ifdef WAVIN_AHC9000_IO_TASK
+  // I/O task: owns the UART and runs transactions from io_requests_, answering on io_results_.
+  // loop() never waits for it. Every bus job is posted and completed on a later loop() call: reads
+  // (channel steps, identity checks, register dump steps) by replaying their results through the
+  // code that issued them, a write job by finish_write_job(), a trace dump by logging a snapshot.
+  // Fault accounting stays on the main loop: the task only counts faults into each result.
+  static constexpr uint8_t IO_SNAPSHOT_TRACE = 0x00;  // request: copy the bus trace to trace_snapshot_
+  static constexpr uint8_t IO_WRITE_JOB = 0x01;       // request: run_write_job(write_job_)
+  static constexpr uint8_t IO_MAX_REGS = 32;      // longest read issued (register dump spans)
+  static constexpr uint8_t IO_MAX_STEP_READS = 2; // transactions per read step
+  struct BusRequest {
+    uint8_t function;  // FC_READ, IO_WRITE_JOB or IO_SNAPSHOT_TRACE
+    uint8_t category;
+    uint8_t page;
+    uint8_t index;
+    uint8_t count;
+  };
+  struct BusResult {
+    bool ok;
+    uint8_t count;
+    uint16_t regs[IO_MAX_REGS];
+    SweepStats stats;  // counters of this transaction, retries included
+    uint8_t faults[BUS_FAULT_KIND_COUNT][8];  // final-attempt failures, for count_bus_fault()
+  };
+  enum IoJobKind : uint8_t { IO_JOB_CHANNEL_STEP, IO_JOB_IDENTITY, IO_JOB_DUMP_STEP, IO_JOB_WRITE, IO_JOB_TRACE };
+  // A posted bus job waiting for its results
+  struct IoJob {
+    bool active{false};
+    uint8_t kind{IO_JOB_CHANNEL_STEP};
+    uint8_t ch{0};
+    uint8_t prio{0};
+    uint8_t only{0};
+    bool probe{false};
+    uint8_t step{0};
+    uint8_t posted{0};
+    uint8_t received{0};
+    BusResult results[IO_MAX_STEP_READS];
+  };
+  bool io_task_enabled_{false};
+  bool io_running_{false};
+  std::atomic<bool> io_stop_{false};     // set by stop_io_task(), polled by the task between requests
+  std::atomic<bool> io_stopped_{false};  // set by the task on its way out
+#ifndef USE_ESP32
+  std::thread io_thread_;
+#endif
+  SpscQueue<BusRequest, 4> io_requests_;
+  SpscQueue<BusResult, 4> io_results_;
+  SweepStats io_task_stats_;
+  uint8_t io_task_faults_[BUS_FAULT_KIND_COUNT][8] = {};  // faults of the request being run (task)
+  std::vector<uint16_t> io_regs_;  // I/O task scratch
+  BusTrace trace_snapshot_;        // copied by the task, logged and released by the main loop
+  IoJob io_job_;
+  uint8_t io_replay_pos_{0};
+  uint8_t io_replay_count_{0};
+  bool io_replaying_{false};
+  void start_io_task();
+  static void io_task_entry(void *arg);
+  void io_task_loop();
+  void io_collect();
+  void io_account_faults(const BusResult &res);
+  bool io_poll_job();
+  void io_post(uint8_t kind, const BusRequest &req);
+  void io_post_channel_step(uint8_t ch_num, uint8_t prio, uint8_t only, bool probe);
+  template<typename... Spans> uint8_t io_post_plan(regmap::ReadPlan<Spans...> /*plan*/, uint8_t page) {
+    return (uint8_t) (0 + ... + (this->io_requests_.push(BusRequest{FC_READ, Spans::CATEGORY, page, Spans::START,
+                                                                     Spans::COUNT}) ? 1 : 0));
+  }
+#endif
+  void register_dump_step();
+  // Trace dump requested while the I/O task owns the trace buffer; served when the bus is free
+  bool trace_dump_due_{false};
+  void update_shadow(uint8_t ch);
+  bool write_is_redundant(uint8_t channel, uint8_t field, uint16_t raw);
+  uint32_t write_elision_max_age_ms_{120000};
+  uint32_t writes_elided_{0};
+#ifdef WAVIN_AHC9000_FAULT_INJECTION
+  bool fault_roll(float probability) const;
+  FaultProfile fault_;
+  std::vector<uint8_t> fault_echo_; // copy of the last request, replayed when tx_echo is set
+  size_t fault_echo_pos_{0};
+  size_t fault_rx_count_{0};        // bytes delivered for the current response
+  size_t fault_truncate_at_{SIZE_MAX};
+  bool fault_silent_{false};
+#endif
+  uint32_t history_window_ms_{3600000};
+  uint16_t history_samples_{96};
+#ifdef WAVIN_AHC9000_NUMBER
   std::map<uint8_t, number::Number *> comfort_numbers_;
   std::map<uint8_t, number::Number *> standby_numbers_;
   std::map<uint8_t, number::Number *> hysteresis_numbers_;
-  std::map<uint8_t, sensor::Sensor *> comfort_setpoint_sensors_;
+#endif
+#ifdef WAVIN_AHC9000_SWITCH
   std::map<uint8_t, switch_::Switch *> child_lock_switches_;
   std::map<uint8_t, switch_::Switch *> standby_switches_;
+#endif
+#ifdef WAVIN_AHC9000_BINARY_SENSOR
   std::map<uint8_t, binary_sensor::BinarySensor *> output_binary_sensors_;
   std::map<uint8_t, binary_sensor::BinarySensor *> problem_binary_sensors_;
+#endif
+#ifdef WAVIN_AHC9000_TEXT_SENSOR
   text_sensor::TextSensor *software_version_sensor_{nullptr};
   text_sensor::TextSensor *hardware_version_sensor_{nullptr};
   text_sensor::TextSensor *device_name_sensor_{nullptr};
-  std::vector<std::string> channel_friendly_names_; // 1-based index mapping (size >=17)
+  text_sensor::TextSensor *register_dump_sensor_{nullptr};
+#endif
+  std::vector<std::string> channel_friendly_names_; // 1-based index mapping (size MAX_CHANNELS + 1)
   std::vector<uint8_t> active_channels_;
-  std::deque<uint8_t> poll_queue_;
-  std::map<uint8_t, climate::ClimateMode> desired_mode_; // desired mode to reconcile after refresh
+  std::deque<uint8_t> bus_queues_[PRIO_COUNT];
+  std::deque<uint8_t> publish_queue_; // channels with fresh state awaiting entity fan-out
+  uint8_t publish_kind_{0};           // next PublishKind of publish_queue_.front()
+  uint32_t publish_spacing_ms_{50};   // 1000 / max_publishes_per_second
+  uint32_t last_publish_ms_{0};
+  struct PublishPolicy {
+    float min_delta;
+    uint32_t heartbeat_ms;
+    uint32_t min_interval_ms;
+  };
+  struct PublishMemo {
+    bool valid{false};
+    bool held{false};  // a change arrived inside min_interval and has not been published yet
+    float value{0.0f};
+    uint32_t last_ms{0};
+  };
+  // Defaults mirror the YAML defaults in __init__.py
+  PublishPolicy publish_policies_[POLICY_COUNT] = {
+      {0.1f, 900000, 0},    // temperature
+      {0.1f, 900000, 0},    // setpoint
+      {2.0f, 1800000, 60000}, // rssi
+      {10.0f, 3600000, 0},  // battery
+      {0.5f, 900000, 0},    // state
+      {1.0f, 900000, 60000}, // statistics
+      {0.05f, 900000, 60000}, // trend
+  };
+  std::map<uint16_t, PublishMemo> publish_memo_; // key: (channel << 8) | PublishKind
+  bool publish_held_{false};
+  uint32_t publish_held_due_ms_{0};  // earliest end of min_interval among held changes
+  std::map<uint8_t, DesiredState> desired_;
+  uint32_t state_seq_{0};
+  // Confirmed commands waiting for their channel's entities to be published
+  struct CommandTiming {
+    uint32_t id;
+    uint32_t issued_ms;
+    uint32_t sent_ms;
+    uint32_t acked_ms;
+    uint32_t confirmed_ms;
+    uint8_t passes;
+  };
+  std::map<uint8_t, CommandTiming> awaiting_publish_;
+  uint32_t next_command_id_{1};
+  uint32_t command_issued_ms_{0};  // set between begin_command() and end_command()
+  static constexpr uint8_t LATENCY_WINDOW = 32;
+  uint32_t latency_ms_[LATENCY_WINDOW]{};
+  uint8_t latency_count_{0};
+  uint8_t latency_pos_{0};
+  uint32_t slow_command_ms_{5000};
+#ifdef WAVIN_AHC9000_SENSOR
+  sensor::Sensor *latency_p50_sensor_{nullptr};
+  sensor::Sensor *latency_p95_sensor_{nullptr};
+#endif
+  void command_published(uint8_t ch);
+  // Scenes still waiting for channels to converge (or give up)
+  struct SceneProgress {
+    uint32_t id;
+    uint32_t start_ms;
+    std::vector<uint8_t> waiting;
+    uint8_t ok;
+    uint8_t failed;
+  };
+  std::vector<SceneProgress> scenes_;
+  uint32_t next_scene_id_{1};
+  std::vector<SceneResultCallback> scene_callbacks_;
+  void scene_result(uint8_t channel, bool ok);
+  // Records one channel's verification result and completes the scene once every channel reported
+  void report_scene_channel(SceneProgress &scene, uint8_t channel, bool ok);
   std::set<uint8_t> strict_mode_channels_; // channels opting into strict baseline writes
 
   float temp_divisor_{10.0f};
@@ -190,11 +987,50 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   GPIOPin *tx_enable_pin_{nullptr};
   GPIOPin *flow_control_pin_{nullptr};
   uint8_t poll_channels_per_cycle_{2};
-  uint8_t next_active_index_{0};
-  uint8_t channel_step_[16] = {0};
-  std::vector<uint8_t> urgent_channels_{}; // channels scheduled for immediate refresh on next update
+  // Weighted poll schedule: each active channel is due every refresh_interval_ms_[ch]
+  std::map<uint8_t, uint32_t> refresh_interval_ms_;
+  std::map<uint8_t, uint32_t> next_due_ms_;
+  uint8_t channel_step_[MAX_CHANNELS] = {0};
+  bool probe_sweep_{false};
+  uint32_t full_read_interval_ms_{300000};
+  uint32_t full_read_ms_[MAX_CHANNELS] = {0}; // last clean full read set; 0 = full read due
+  // Learned reporting schedule of a channel's wireless element (see observe_element())
+  struct ElementSchedule {
+    uint32_t last_read_ms{0};   // last successful element block read
+    uint32_t last_change_ms{0}; // estimated time of the last report that changed the block
+    uint32_t period_ms{0};      // estimated reporting period (0 = none yet)
+    uint8_t intervals{0};       // change intervals folded into period_ms
+    uint8_t misses{0};          // reads since an expected report that found no change
+    uint8_t widen{0};           // window widening earned by late reports, paid back by on-time ones
+  };
+  static constexpr uint8_t ELEMENT_LEARN_INTERVALS = 3;
+  static constexpr uint8_t ELEMENT_RELEARN_PERIODS = 3;  // silence that drops a locked schedule
+  static constexpr uint32_t ELEMENT_MIN_PERIOD_MS = 10000;
+  static constexpr uint32_t ELEMENT_MIN_WINDOW_MS = 5000;
+  static constexpr float ELEMENT_WEAK_RSSI_DBM = -80.0f;
+  bool element_phase_polling_{false};
+  ElementSchedule element_sched_[MAX_CHANNELS];
+  bool element_only_[MAX_CHANNELS] = {false}; // routine queue entry is an element-only read
+  bool full_read_due_[MAX_CHANNELS] = {false}; // verify entry stands in for a full read (refresh, displaced poll)
+  void observe_element(uint8_t ch_num, bool changed, uint32_t now);
+  uint32_t element_window_ms(uint8_t ch_num) const;
+  uint32_t element_due_ms(uint8_t ch_num, uint32_t now) const;
+  bool element_read_due(uint8_t ch_num, uint8_t only);
   bool allow_mode_writes_{true};
-  bool device_info_read_{false};
+  struct ControllerIdentity {
+    uint16_t hw_version{0};
+    uint16_t sw_version{0};
+    uint16_t device_name{0};
+    bool known{false};
+  };
+  ControllerIdentity identity_;
+  uint32_t identity_check_interval_ms_{60000};
+  uint32_t identity_checked_ms_{0}; // last answered check
+  bool identity_check_due_{true};
+  uint8_t identity_failures_{0};    // consecutive unanswered checks
+  // Unanswered checks in a row that count as an outage (reboot, power cut) rather than bus noise
+  static constexpr uint8_t IDENTITY_OUTAGE_FAILURES = 2;
+  uint32_t resyncs_{0};
 
   // Protocol constants
   static constexpr uint8_t DEVICE_ADDR = 0x01;
@@ -220,7 +1056,7 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
 
   static constexpr uint8_t ELEM_AIR_TEMPERATURE = 0x04; // index within block
   static constexpr uint8_t ELEM_FLOOR_TEMPERATURE = 0x05; // index for floor probe
-  static constexpr uint8_t ELEM_BATTERY_STATUS = 0x0A;  // not used yet
+  static constexpr uint8_t ELEM_BATTERY_STATUS = 0x0A;
   static constexpr uint8_t ELEM_RSSI = 0x09; // RSSI register (16-bit: high byte=element, low byte=CU)
 
   static constexpr uint8_t PACKED_MANUAL_TEMPERATURE = 0x00;
@@ -241,21 +1077,79 @@ class WavinAHC9000 : public PollingComponent, public uart::UARTDevice {
   static constexpr uint16_t PACKED_CONFIGURATION_STRICT_UNLOCK_MASK = 0x0078; // bits 3..6 (avoid touching mode bits 0..2)
   static constexpr uint16_t PACKED_CONFIGURATION_CHILD_LOCK_MASK = 0x0800; // child lock bit (0x4000->0x4800)
 
+  // --- Register map: per-step read plans (see regmap) ---
+  // Status word (output bit) and primary element share one 3-register read; with the element block
+  // this is also the change probe of a probe sweep
+  using ChannelStatusPlan = regmap::ReadPlan<
+      regmap::ReadSpan<CAT_CHANNELS,
+          regmap::Reg<CH_TIMER_EVENT, regmap::Bits<0xFFFF>, &ChannelState::raw_status>,
+          regmap::Reg<CH_TIMER_EVENT, regmap::OutputAction<CH_TIMER_EVENT_OUTP_ON_MASK>, &ChannelState::action>,
+          regmap::Reg<CH_PRIMARY_ELEMENT, regmap::Bits<CH_PRIMARY_ELEMENT_ELEMENT_MASK>, &ChannelState::primary_index>,
+          regmap::Reg<CH_PRIMARY_ELEMENT, regmap::Flag<CH_PRIMARY_ELEMENT_ALL_TP_LOST_MASK>, &ChannelState::all_tp_lost>>>;
+  using ConfigurationPlan = regmap::ReadPlan<
+      regmap::ReadSpan<CAT_PACKED,
+          regmap::Reg<PACKED_CONFIGURATION, regmap::Bits<0xFFFF>, &ChannelState::raw_config>,
+          regmap::Reg<PACKED_CONFIGURATION,
+                      regmap::Mode<PACKED_CONFIGURATION_MODE_MASK, PACKED_CONFIGURATION_MODE_STANDBY, PACKED_CONFIGURATION_MODE_STANDBY_ALT>,
+                      &ChannelState::mode, FIELD_MODE>,
+          regmap::Reg<PACKED_CONFIGURATION, regmap::Flag<PACKED_CONFIGURATION_CHILD_LOCK_MASK>, &ChannelState::child_lock, FIELD_CHILD_LOCK>>>;
+  // Manual and standby setpoints are 4 registers apart: one 5-register read instead of two transactions
+  using SetpointPlan = regmap::ReadPlan<
+      regmap::ReadSpan<CAT_PACKED,
+          regmap::Reg<PACKED_MANUAL_TEMPERATURE, regmap::Temperature, &ChannelState::setpoint_c, FIELD_SETPOINT>,
+          regmap::Reg<PACKED_STANDBY_TEMPERATURE, regmap::Temperature, &ChannelState::standby_setpoint_c, FIELD_STANDBY_SETPOINT>>,
+      regmap::ReadSpan<CAT_PACKED,
+          regmap::Reg<PACKED_HYSTERESIS, regmap::Tenths, &ChannelState::hysteresis_c, FIELD_HYSTERESIS>>>;
+  using FloorLimitsPlan = regmap::ReadPlan<
+      regmap::ReadSpan<CAT_PACKED,
+          regmap::Reg<PACKED_FLOOR_MIN_TEMPERATURE, regmap::Temperature, &ChannelState::floor_min_c, FIELD_FLOOR_MIN>,
+          regmap::Reg<PACKED_FLOOR_MAX_TEMPERATURE, regmap::Temperature, &ChannelState::floor_max_c, FIELD_FLOOR_MAX>>>;
+  // Element block is addressed by the primary element page; RSSI sits inside the block, no extra read
+  using ElementPlan = regmap::ReadPlan<
+      regmap::ReadSpan<CAT_ELEMENTS,
+          regmap::Reg<ELEM_AIR_TEMPERATURE, regmap::Temperature, &ChannelState::current_temp_c>,
+          regmap::Reg<ELEM_FLOOR_TEMPERATURE, regmap::FloorProbe, &ChannelState::floor_temp_c>,
+          regmap::Reg<ELEM_FLOOR_TEMPERATURE, regmap::FloorProbePresent, &ChannelState::has_floor_sensor>,
+          regmap::Reg<ELEM_RSSI, regmap::RssiByte<8>, &ChannelState::rssi_element_dbm>,
+          regmap::Reg<ELEM_RSSI, regmap::RssiByte<0>, &ChannelState::rssi_cu_dbm>,
+          regmap::Reg<ELEM_BATTERY_STATUS, regmap::BatterySteps, &ChannelState::battery_pct>>>;
+
+  // Areas covered by the register dump: pages and registers per page are upper bounds, spans that
+  // run past the end of a block fail and are split down to single registers.
+  struct DumpArea {
+    uint8_t category;
+    uint8_t pages;
+    uint8_t registers;
+  };
+  static constexpr DumpArea DUMP_AREAS[] = {
+      {CAT_INFO, 1, 32},
+      {CAT_CHANNELS, MAX_CHANNELS, 16},
+      {CAT_PACKED, MAX_CHANNELS, 32},
+      {CAT_ELEMENTS, 64, 16},
+  };
+  static constexpr uint8_t DUMP_AREA_COUNT = sizeof(DUMP_AREAS) / sizeof(DUMP_AREAS[0]);
   // I/O reliability: number of attempts for read/write before escalating to WARN
   static constexpr uint8_t IO_RETRY_ATTEMPTS = 2; // first failure logged at DEBUG, final at WARN
+  // Reconciler: correction passes per desired change before giving up
+  static constexpr uint8_t RECONCILE_MAX_ATTEMPTS = 3;
 };
 
+#ifdef WAVIN_AHC9000_NUMBER
 // --- WavinSetpointNumber::control defined here, after WavinAHC9000 is fully declared ---
 inline void WavinSetpointNumber::control(float value) {
   if (this->parent_ == nullptr) return;
+  this->parent_->begin_command();
   if (this->type_ == HYSTERESIS) {
     this->parent_->write_channel_hysteresis(this->channel_, value);
   } else {
     this->parent_->write_channel_setpoint(this->channel_, value);
   }
+  this->parent_->end_command();
   this->publish_state(value);
 }
+#endif
 
+#ifdef WAVIN_AHC9000_SWITCH
 // Generic switch subclass for child lock and standby control.
 class WavinSwitch : public switch_::Switch {
  public:
@@ -269,7 +1163,9 @@ class WavinSwitch : public switch_::Switch {
   uint8_t channel_{0};
   Type type_{CHILD_LOCK};
 };
+#endif
 
+#ifdef WAVIN_AHC9000_SENSOR
 // Inline helpers for configuring sensors
 inline void WavinAHC9000::add_channel_battery_sensor(uint8_t ch, sensor::Sensor *s) {
   this->battery_sensors_[ch] = s;
@@ -303,11 +1199,33 @@ inline void WavinAHC9000::add_channel_rssi_cu_sensor(uint8_t ch, sensor::Sensor
   this->rssi_cu_sensors_[ch] = s;
 }
 
+inline void WavinAHC9000::add_channel_temperature_trend_sensor(uint8_t ch, sensor::Sensor *s) {
+  this->temperature_trend_sensors_[ch] = s;
+  this->histories_[ch];
+}
+
+inline void WavinAHC9000::add_channel_floor_temperature_trend_sensor(uint8_t ch, sensor::Sensor *s) {
+  this->floor_temperature_trend_sensors_[ch] = s;
+  this->histories_[ch];
+}
+
+inline void WavinAHC9000::add_channel_duty_cycle_sensor(uint8_t ch, sensor::Sensor *s) {
+  this->duty_cycle_sensors_[ch] = s;
+  this->histories_[ch];
+}
+
+inline void WavinAHC9000::add_channel_on_time_sensor(uint8_t ch, sensor::Sensor *s) {
+  this->on_time_sensors_[ch] = s;
+  this->histories_[ch];
+}
+#endif
+
+#ifdef WAVIN_AHC9000_NUMBER
 inline void WavinAHC9000::add_comfort_number(number::Number *n) {
   auto ptr = static_cast<WavinSetpointNumber *>(n);
   if (ptr == nullptr) return;
   uint8_t ch = ptr->get_channel();
-  if (ch < 1 || ch > 16) return;
+  if (ch < 1 || ch > MAX_CHANNELS) return;
   this->comfort_numbers_[ch] = n;
 }
 
@@ -315,7 +1233,7 @@ inline void WavinAHC9000::add_standby_number(number::Number *n) {
   auto ptr = static_cast<WavinSetpointNumber *>(n);
   if (ptr == nullptr) return;
   uint8_t ch = ptr->get_channel();
-  if (ch < 1 || ch > 16) return;
+  if (ch < 1 || ch > MAX_CHANNELS) return;
   this->standby_numbers_[ch] = n;
 }
 
@@ -323,9 +1241,34 @@ inline void WavinAHC9000::add_hysteresis_number(number::Number *n) {
   auto ptr = static_cast<WavinSetpointNumber *>(n);
   if (ptr == nullptr) return;
   uint8_t ch = ptr->get_channel();
-  if (ch < 1 || ch > 16) return;
+  if (ch < 1 || ch > MAX_CHANNELS) return;
   this->hysteresis_numbers_[ch] = n;
 }
+#endif
+
+#ifdef WAVIN_AHC9000_BUTTON
+// Button that logs the captured bus trace
+class WavinTraceDumpButton : public button::Button {
+ public:
+  void set_parent(WavinAHC9000 *p) { this->parent_ = p; }
+ protected:
+  void press_action() override {
+    if (this->parent_ != nullptr) this->parent_->dump_bus_trace();
+  }
+  WavinAHC9000 *parent_{nullptr};
+};
+
+// Button that starts a background dump of all controller registers
+class WavinRegisterDumpButton : public button::Button {
+ public:
+  void set_parent(WavinAHC9000 *p) { this->parent_ = p; }
+ protected:
+  void press_action() override {
+    if (this->parent_ != nullptr) this->parent_->start_register_dump();
+  }
+  WavinAHC9000 *parent_{nullptr};
+};
+#endif
 
 class WavinZoneClimate : public climate::Climate, public Component {
  public:
@@ -344,7 +1287,15 @@ class WavinZoneClimate : public climate::Climate, public Component {
 
   void dump_config() override;
 
+  bool is_single_channel() const { return this->single_channel_set_; }
+  uint8_t get_single_channel() const { return this->single_channel_set_ ? this->single_channel_ : 0; }
+  const std::vector<uint8_t> &get_members() const { return this->members_; }
+
   void update_from_parent();
+  // Subscribed through the hub; folds a member change into the aggregates and marks the state dirty
+  void on_channel_change(uint8_t ch, uint16_t changed);
+  // Publishes if a change arrived since the last publish; returns whether it did
+  bool publish_if_dirty();
 
  protected:
   climate::ClimateTraits traits() override;
@@ -355,6 +1306,25 @@ class WavinZoneClimate : public climate::Climate, public Component {
   bool single_channel_set_{false};
   std::vector<uint8_t> members_{};
   bool use_floor_temperature_{false};
+  bool dirty_{false};
+
+  // Group aggregates, kept incrementally from member notifications. Temperatures are summed in
+  // hundredths of a degree so repeated add/remove cannot drift.
+  struct MemberContribution {
+    int32_t current_cd{0};
+    int32_t setpoint_cd{0};
+    bool has_current{false};
+    bool has_setpoint{false};
+    bool heating{false};
+    bool off{false};
+  };
+  std::vector<MemberContribution> contributions_{};
+  int32_t sum_current_cd_{0};
+  int32_t sum_setpoint_cd_{0};
+  uint8_t n_current_{0};
+  uint8_t n_setpoint_{0};
+  uint8_t n_heating_{0};
+  uint8_t n_off_{0};
 };
 
 }  // namespace wavinahc9000v3
@@ -0,0 +1,98 @@
+// Cross-checks the CRC16 variants in crc16.h against the bitwise reference and times them.
+//
+//   crc_bench [frames]   (default 200000 frames of 8..64 bytes)
+//
+// Exits non-zero on any mismatch, so ctest runs it with a small frame count as a correctness check.
+#include "crc16.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace esphome::wavinahc9000v3;
+
+typedef uint16_t (*CrcUpdate)(uint16_t, uint8_t);
+
+static uint16_t run(CrcUpdate update, const std::vector<std::vector<uint8_t>> &frames) {
+  uint16_t acc = 0;
+  for (const auto &f : frames) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t b : f) crc = update(crc, b);
+    acc ^= crc;
+  }
+  return acc;
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? (size_t) std::strtoul(argv[1], nullptr, 10) : 200000;
+  struct Variant {
+    const char *name;
+    CrcUpdate update;
+    size_t table_bytes;
+  } variants[] = {
+      {"bitwise", crc16_update_bitwise, 0},
+      {"nibble", crc16_update_nibble, sizeof(CRC16_NIBBLE_TABLE)},
+      {"byte", crc16_update_byte, sizeof(CRC16_BYTE_TABLE)},
+  };
+  int failures = 0;
+
+  // Modbus check value for "123456789"
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  for (auto &v : variants) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t b : check) crc = v.update(crc, b);
+    if (crc != 0x4B37) {
+      std::printf("FAIL %s: check value %04X, expected 4B37\n", v.name, crc);
+      failures++;
+    }
+  }
+
+  // Random frames at the sizes the bus carries (8-byte reads up to long block responses)
+  std::mt19937 rng(12345);
+  std::vector<std::vector<uint8_t>> frames(count);
+  size_t total = 0;
+  for (auto &f : frames) {
+    f.resize(8 + rng() % 57);
+    for (auto &b : f) b = (uint8_t) rng();
+    total += f.size();
+  }
+  for (const auto &f : frames) {
+    uint16_t ref = 0xFFFF, nib = 0xFFFF, byt = 0xFFFF;
+    for (uint8_t b : f) {
+      ref = crc16_update_bitwise(ref, b);
+      nib = crc16_update_nibble(nib, b);
+      byt = crc16_update_byte(byt, b);
+    }
+    if (nib != ref || byt != ref) {
+      std::printf("FAIL: %zu-byte frame bitwise=%04X nibble=%04X byte=%04X\n", f.size(), ref, nib, byt);
+      failures++;
+      break;
+    }
+    // A frame with its CRC appended must leave the streaming state at zero
+    Crc16Stream s;
+    for (uint8_t b : f) s.update(b);
+    uint16_t crc = crc16(f.data(), f.size());
+    s.update((uint8_t) (crc & 0xFF));
+    s.update((uint8_t) (crc >> 8));
+    if (!s.frame_ok()) {
+      std::printf("FAIL: streaming CRC did not close on a %zu-byte frame\n", f.size());
+      failures++;
+      break;
+    }
+  }
+
+  std::printf("%zu frames, %zu bytes\n", count, total);
+  std::printf("%-8s %8s %10s %12s\n", "variant", "table", "ns/byte", "checksum");
+  for (auto &v : variants) {
+    auto start = std::chrono::steady_clock::now();
+    uint16_t acc = run(v.update, frames);
+    auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-8s %7zuB %10.2f %8s%04X\n", v.name, v.table_bytes, total ? ns / total : 0.0, "", acc);
+  }
+
+  if (failures) return 1;
+  std::printf("all variants match the bitwise reference\n");
+  return 0;
+}
@@ -0,0 +1,116 @@
+// Element phase polling against a simulated wireless element that reports every PERIOD_MS: the hub
+// learns the period, then reads the element block just after each expected report instead of on
+// every routine poll. Checks that the period is learned (the first read after boot is no report),
+// that element reads drop to about one per report while each report still reaches the cache within
+// the read window, and that an element that stops reporting sends the channel back to learning.
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "loop_runner.h"
+
+#include <string>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint32_t UPDATE_MS = 5000;
+static constexpr uint32_t PERIOD_MS = 90000;
+// First report well after boot: the boot read must not pass for a report
+static constexpr uint32_t PHASE_MS = 40000;
+// Read window after an expected report: a tenth of the period, at least 5 s
+static constexpr uint32_t WINDOW_MS = PERIOD_MS / 10;
+static constexpr uint8_t ELEM_AIR_TEMPERATURE = 0x04;
+
+struct Rig {
+  FakeController controller;
+  WavinAHC9000 hub;
+  LoopRunner runner;
+  uint32_t next_report_ms{PHASE_MS};
+  uint32_t last_report_ms{0};
+  uint16_t air_raw{210};
+  bool reporting{true};
+  // Element block reads seen by the hub (read time of the element step changed)
+  uint32_t element_reads{0};
+  uint32_t last_element_read_ms{0};
+  // Longest time from a report until the hub held its value
+  uint32_t worst_delay_ms{0};
+  bool report_pending{false};
+
+  Rig() {
+    this->controller.set_zone(1, FakeController::Zone{});
+    this->hub.set_uart_parent(&this->controller);
+    this->hub.set_update_interval(UPDATE_MS);
+    this->hub.set_identity_check_interval_ms(0);
+    this->hub.set_element_phase_polling(true);
+    this->hub.add_active_channel(1);
+    this->runner.add(&this->hub);
+    this->runner.setup();
+  }
+
+  const ChannelState &channel() { return this->hub.get_state_view().channels.at(1); }
+
+  // Advances in 100 ms slices, delivering element reports and watching the element step
+  void run(uint32_t ms) {
+    uint32_t end = millis() + ms;
+    while ((int32_t) (millis() - end) < 0) {
+      if (this->reporting && (int32_t) (millis() - this->next_report_ms) >= 0) {
+        this->air_raw = this->air_raw == 210 ? 211 : 210;
+        this->controller.set_register(FakeController::CAT_ELEMENTS, 0, ELEM_AIR_TEMPERATURE, this->air_raw);
+        this->last_report_ms = millis();
+        this->next_report_ms += PERIOD_MS;
+        this->report_pending = true;
+      }
+      this->runner.run_for(100);
+      if (this->hub.get_state_view().channels.count(1) == 0) continue;
+      uint32_t read_ms = this->channel().field_read_ms(CHANGE_TEMPERATURE);
+      if (read_ms != this->last_element_read_ms) {
+        this->last_element_read_ms = read_ms;
+        this->element_reads++;
+      }
+      if (this->report_pending && std::fabs(this->channel().current_temp_c - this->air_raw / 10.0f) < 0.01f) {
+        this->report_pending = false;
+        this->worst_delay_ms = std::max(this->worst_delay_ms, millis() - this->last_report_ms);
+      }
+    }
+  }
+};
+
+static bool logged(const std::vector<std::string> &lines, const char *text) {
+  for (const auto &line : lines) {
+    if (line.find(text) != std::string::npos) return true;
+  }
+  return false;
+}
+
+int main() {
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+  host::reset_clock();
+  Rig rig;
+
+  // Learning: the element block is read on every routine poll
+  host::start_log_capture();
+  rig.run(8 * PERIOD_MS);
+  EXPECT(c, logged(host::stop_log_capture(), "element reports about every 90s"));
+
+  // Locked: reads follow the reports
+  rig.element_reads = 0;
+  rig.worst_delay_ms = 0;
+  rig.run(10 * PERIOD_MS);
+  std::printf("locked: %u element reads over 10 reports (%u routine polls), worst report delay %ums\n",
+              (unsigned) rig.element_reads, (unsigned) (10 * PERIOD_MS / UPDATE_MS), (unsigned) rig.worst_delay_ms);
+  EXPECT(c, rig.element_reads <= 2 * 10);
+  EXPECT(c, rig.worst_delay_ms <= WINDOW_MS + UPDATE_MS);
+
+  // The element goes quiet: reads fall back to every routine poll and the schedule is relearned
+  rig.reporting = false;
+  host::start_log_capture();
+  rig.run(5 * PERIOD_MS);
+  EXPECT(c, logged(host::stop_log_capture(), "element stopped reporting on schedule, relearning"));
+  rig.element_reads = 0;
+  rig.run(3 * PERIOD_MS);
+  EXPECT(c, rig.element_reads >= 3 * PERIOD_MS / UPDATE_MS - 1);
+
+  return c.result("element_phase");
+}
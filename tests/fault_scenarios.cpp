@@ -0,0 +1,123 @@
+// Runs the hub against the simulated controller through the fault shim, once per bus impairment,
+// and reports per scenario what a degraded bus costs: sweep wall time, the age of the stalest
+// channel at sweep end, the longest single loop() call and the fault counters. Every run uses the
+// same seed and simulated clock, so the table is comparable across code changes.
+//
+//   fault_scenarios [minutes]   (simulated minutes per scenario, default 10)
+//
+// Exits non-zero if a scenario completes no sweep, the clean bus shows faults, or the hub ends a
+// scenario holding values the controller never had.
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "fault_uart.h"
+#include "loop_runner.h"
+
+#include <cstdlib>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+struct ScenarioResult {
+  uint32_t sweeps{0};
+  uint64_t wall_ms_sum{0};
+  uint32_t wall_ms_max{0};
+  uint32_t data_age_ms_max{0};
+  uint32_t loop_us_max{0};
+  uint32_t transactions{0};
+  uint32_t timeouts{0};
+  uint32_t crc_errors{0};
+  uint8_t wrong_channels{0};
+};
+
+static ScenarioResult run_scenario(const Impairments &impairments, uint32_t minutes) {
+  host::reset_clock();
+  FakeController controller;
+  for (uint8_t ch = 1; ch <= MAX_CHANNELS; ch++) {
+    FakeController::Zone zone;
+    zone.air_c = 18.0f + ch * 0.3f;
+    zone.setpoint_c = 20.0f + (ch % 4) * 0.5f;
+    zone.heating = ch % 3 == 0;
+    controller.set_zone(ch, zone);
+  }
+  FaultUart uart(&controller, impairments, 42);
+
+  WavinAHC9000 hub;
+  hub.set_uart_parent(&uart);
+  LoopRunner runner;
+  runner.add(&hub);
+  runner.setup();
+
+  ScenarioResult r;
+  SweepStats last{};
+  auto same = [](const SweepStats &a, const SweepStats &b) {
+    return a.transactions == b.transactions && a.wall_ms == b.wall_ms && a.bus_us == b.bus_us &&
+           a.max_loop_us == b.max_loop_us;
+  };
+  // Look at every loop iteration so no completed sweep is missed
+  runner.run_for(minutes * 60000, [&] {
+    const SweepStats &s = hub.get_last_sweep_stats();
+    if (s.transactions == 0 || same(s, last)) return false;
+    last = s;
+    r.sweeps++;
+    r.wall_ms_sum += s.wall_ms;
+    r.wall_ms_max = std::max(r.wall_ms_max, s.wall_ms);
+    r.data_age_ms_max = std::max(r.data_age_ms_max, s.max_data_age_ms);
+    r.loop_us_max = std::max(r.loop_us_max, s.max_loop_us);
+    r.transactions += s.transactions;
+    r.timeouts += s.timeouts;
+    r.crc_errors += s.crc_errors;
+    return false;
+  });
+
+  // Whatever got through must be what the controller holds: faults may delay data, never corrupt it
+  auto view = hub.get_state_view();
+  for (uint8_t ch = 1; ch <= MAX_CHANNELS; ch++) {
+    auto it = view.channels.find(ch);
+    if (it == view.channels.end() || std::isnan(it->second.current_temp_c)) continue;
+    float want = controller.get_register(FakeController::CAT_ELEMENTS, ch - 1, 0x04) / 10.0f;
+    if (std::fabs(it->second.current_temp_c - want) > 0.01f) r.wrong_channels++;
+  }
+  return r;
+}
+
+int main(int argc, char **argv) {
+  uint32_t minutes = argc > 1 ? (uint32_t) std::strtoul(argv[1], nullptr, 10) : 10;
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  const Impairments scenarios[] = {
+      {"clean"},
+      {"drop 0.1%", 0.001f},
+      {"drop 1%", 0.01f},
+      {"bit flip 0.05%", 0.0f, 0.0005f},
+      {"bit flip 0.5%", 0.0f, 0.005f},
+      {"truncate 2%", 0.0f, 0.0f, 0.02f},
+      {"silence 2%", 0.0f, 0.0f, 0.0f, 0.02f},
+      {"silence 20%", 0.0f, 0.0f, 0.0f, 0.2f},
+      {"latency 40ms", 0.0f, 0.0f, 0.0f, 0.0f, 40},
+      {"latency 400ms", 0.0f, 0.0f, 0.0f, 0.0f, 400},
+      {"tx echo", 0.0f, 0.0f, 0.0f, 0.0f, 0, true},
+      {"mixed", 0.001f, 0.0005f, 0.02f, 0.02f, 40},
+  };
+
+  Checks c;
+  std::printf("%u channels, %u simulated min per scenario\n", (unsigned) MAX_CHANNELS, (unsigned) minutes);
+  std::printf("%-15s %6s %10s %10s %12s %12s %8s %8s %6s\n", "scenario", "sweeps", "sweep avg", "sweep max",
+              "data age max", "loop() max", "timeouts", "crc", "wrong");
+  for (const auto &s : scenarios) {
+    ScenarioResult r = run_scenario(s, minutes);
+    double avg_s = r.sweeps ? r.wall_ms_sum / 1000.0 / r.sweeps : 0.0;
+    std::printf("%-15s %6u %9.1fs %9.1fs %11.1fs %10.1fms %8u %8u %6u\n", s.name, (unsigned) r.sweeps, avg_s,
+                r.wall_ms_max / 1000.0, r.data_age_ms_max / 1000.0, r.loop_us_max / 1000.0, (unsigned) r.timeouts,
+                (unsigned) r.crc_errors, (unsigned) r.wrong_channels);
+    if (r.sweeps == 0) std::fprintf(stderr, "FAIL: scenario '%s' completed no sweep\n", s.name);
+    c.failures += r.sweeps == 0;
+    if (r.wrong_channels != 0) std::fprintf(stderr, "FAIL: scenario '%s' accepted corrupt data\n", s.name);
+    c.failures += r.wrong_channels != 0;
+    if (&s == &scenarios[0]) {
+      EXPECT(c, r.timeouts == 0);
+      EXPECT(c, r.crc_errors == 0);
+    }
+  }
+  return c.result("fault_scenarios");
+}
@@ -0,0 +1,144 @@
+// Runs the hub on the real clock against the simulated controller behind a slow bus, once with bus
+// I/O on the main loop and once with the I/O thread (WAVIN_AHC9000_IO_TASK), and reports what each
+// costs loop(): the longest iteration during routine sweeps and during a setpoint write. Checks that
+// both modes decode the same state, that a write goes through the thread and is verified without
+// blocking loop(), and that stop_io_task() joins the thread and hands the bus back to the main loop.
+//
+//   io_task_test [latency_ms]   (response latency added to every transaction, default 100)
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "fault_uart.h"
+#include "loop_runner.h"
+
+#include <cstdlib>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint8_t CHANNELS = 2;
+
+struct ModeResult {
+  uint32_t sweep_loop_us_max{0};
+  uint32_t write_loop_us_max{0};
+  bool decoded{false};
+  bool write_verified{false};
+  bool controller_written{false};
+  bool resumed_inline{false};
+};
+
+static bool state_matches(WavinAHC9000 &hub, float setpoint_ch1) {
+  auto view = hub.get_state_view();
+  for (uint8_t ch = 1; ch <= CHANNELS; ch++) {
+    auto it = view.channels.find(ch);
+    if (it == view.channels.end() || !it->second.read_clean) return false;
+    if (std::fabs(it->second.current_temp_c - (18.0f + ch)) > 0.01f) return false;
+    float setpoint = ch == 1 ? setpoint_ch1 : 20.0f + ch * 0.5f;
+    if (std::fabs(it->second.setpoint_c - setpoint) > 0.01f) return false;
+  }
+  return true;
+}
+
+static ModeResult run_mode(bool io_task, uint32_t latency_ms, Checks &c) {
+  FakeController controller;
+  for (uint8_t ch = 1; ch <= CHANNELS; ch++) {
+    FakeController::Zone zone;
+    zone.air_c = 18.0f + ch;
+    zone.setpoint_c = 20.0f + ch * 0.5f;
+    controller.set_zone(ch, zone);
+  }
+  Impairments slow{"slow"};
+  slow.latency_ms = latency_ms;
+  FaultUart uart(&controller, slow, 7);
+
+  ModeResult r;
+  {
+    WavinAHC9000 hub;
+    hub.set_uart_parent(&uart);
+    hub.set_update_interval(1000);
+    hub.set_poll_channels_per_cycle(CHANNELS);
+    for (uint8_t ch = 1; ch <= CHANNELS; ch++) hub.add_active_channel(ch);
+    hub.set_io_task(io_task);
+    LoopRunner runner;
+    runner.add(&hub);
+    runner.setup();
+    EXPECT(c, hub.is_io_task_running() == io_task);
+
+    // Discovery, then one routine sweep with every channel read
+    r.decoded = runner.run_for(20000, [&] { return state_matches(hub, 20.5f); });
+    runner.reset_max_iteration();
+    runner.run_for(2500);
+    r.sweep_loop_us_max = runner.get_max_iteration_us();
+
+    // The write job and its verification read
+    runner.reset_max_iteration();
+    hub.write_channel_setpoint(1, 23.5f);
+    r.write_verified = runner.run_for(10000, [&] { return state_matches(hub, 23.5f); });
+    r.write_loop_us_max = runner.get_max_iteration_us();
+
+    if (io_task) {
+      hub.stop_io_task();
+      EXPECT(c, !hub.is_io_task_running());
+      // Back on the main loop: the next sweep still reaches the controller
+      uint32_t requests = controller.get_requests();
+      runner.run_for(3000);
+      r.resumed_inline = controller.get_requests() > requests && state_matches(hub, 23.5f);
+    }
+    // Leaving the scope destroys the hub; with a running task the destructor has to join it
+  }
+  r.controller_written = controller.get_register(FakeController::CAT_PACKED, 0, 0x00) == 235;
+  return r;
+}
+
+// A hub destroyed with its thread still running must stop and join it, not leave it on a dead object
+static void check_destructor_joins(Checks &c) {
+  FakeController controller;
+  FakeController::Zone zone;
+  controller.set_zone(1, zone);
+  {
+    WavinAHC9000 hub;
+    hub.set_uart_parent(&controller);
+    hub.add_active_channel(1);
+    hub.set_io_task(true);
+    LoopRunner runner;
+    runner.add(&hub);
+    runner.setup();
+    runner.run_for(300);
+    EXPECT(c, hub.is_io_task_running());
+  }
+  uint32_t requests = controller.get_requests();
+  delay(200);
+  EXPECT(c, controller.get_requests() == requests);
+}
+
+int main(int argc, char **argv) {
+  uint32_t latency_ms = argc > 1 ? (uint32_t) std::strtoul(argv[1], nullptr, 10) : 100;
+  host::set_clock_mode(host::CLOCK_REAL);
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+
+  ModeResult inline_io = run_mode(false, latency_ms, c);
+  ModeResult threaded = run_mode(true, latency_ms, c);
+  check_destructor_joins(c);
+
+  std::printf("%u channels, %u ms response latency\n", (unsigned) CHANNELS, (unsigned) latency_ms);
+  std::printf("%-10s %16s %16s\n", "bus I/O", "loop() sweeping", "loop() writing");
+  std::printf("%-10s %14.1fms %14.1fms\n", "main loop", inline_io.sweep_loop_us_max / 1000.0,
+              inline_io.write_loop_us_max / 1000.0);
+  std::printf("%-10s %14.1fms %14.1fms\n", "io thread", threaded.sweep_loop_us_max / 1000.0,
+              threaded.write_loop_us_max / 1000.0);
+
+  for (const ModeResult *r : {&inline_io, &threaded}) {
+    EXPECT(c, r->decoded);
+    EXPECT(c, r->write_verified);
+    EXPECT(c, r->controller_written);
+  }
+  EXPECT(c, threaded.resumed_inline);
+  // Inline, every bus job waits out the latency; on the thread neither reads nor writes block loop()
+  EXPECT(c, inline_io.sweep_loop_us_max >= latency_ms * 1000);
+  EXPECT(c, inline_io.write_loop_us_max >= latency_ms * 1000);
+  EXPECT(c, threaded.sweep_loop_us_max < latency_ms * 1000 / 2);
+  EXPECT(c, threaded.write_loop_us_max < latency_ms * 1000 / 2);
+  return c.result("io_task");
+}
@@ -0,0 +1,94 @@
+// Checks how the hub learns whether the controller applies multi-register writes. Floor min and
+// max are adjacent registers, so writing both merges them into one FC_WRITE with count 2:
+//   - firmware that applies only the first register: fall back to single writes for good
+//   - a clamped value: the register still changed, so merging stays on
+//   - a multi-write that gets no answer: no conclusion, the next merged write probes again
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "loop_runner.h"
+
+#include <string>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint8_t FLOOR_MIN = 0x0A;
+static constexpr uint8_t FLOOR_MAX = 0x0B;
+
+struct Rig {
+  FakeController controller;
+  WavinAHC9000 hub;
+  LoopRunner runner;
+
+  Rig() {
+    this->controller.set_zone(1, FakeController::Zone{});
+    this->hub.set_uart_parent(&this->controller);
+    this->hub.add_active_channel(1);
+    this->runner.add(&this->hub);
+    this->runner.setup();
+    this->runner.run_for(10000, [this] { return this->hub.get_last_sweep_stats().transactions != 0; });
+  }
+
+  // Writes both limits and waits until the controller holds want_min / want_max; returns the number
+  // of multi-register writes it took, or -1 if the values never arrived
+  int write_limits(float min_c, float max_c, uint16_t want_min, uint16_t want_max) {
+    uint32_t multi = this->controller.get_multi_writes();
+    this->hub.write_channel_floor_min_temperature(1, min_c);
+    this->hub.write_channel_floor_max_temperature(1, max_c);
+    bool landed = this->runner.run_for(30000, [&] {
+      return this->controller.get_register(FakeController::CAT_PACKED, 0, FLOOR_MIN) == want_min &&
+             this->controller.get_register(FakeController::CAT_PACKED, 0, FLOOR_MAX) == want_max;
+    });
+    // Let the verification read and any corrections finish before the next write
+    this->runner.run_for(5000);
+    return landed ? (int) (this->controller.get_multi_writes() - multi) : -1;
+  }
+};
+
+static bool logged_fallback(const std::vector<std::string> &lines) {
+  for (const auto &line : lines) {
+    if (line.find("using single-register writes") != std::string::npos) return true;
+  }
+  return false;
+}
+
+int main() {
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+
+  {
+    host::reset_clock();
+    Rig rig;
+    rig.controller.set_multi_write_supported(false);
+    host::start_log_capture();
+    EXPECT(c, rig.write_limits(19.0f, 27.0f, 190, 270) == 1);
+    EXPECT(c, rig.write_limits(20.0f, 26.0f, 200, 260) == 0);
+    EXPECT(c, logged_fallback(host::stop_log_capture()));
+  }
+
+  {
+    host::reset_clock();
+    Rig rig;
+    rig.controller.set_clamp(FakeController::CAT_PACKED, 0, FLOOR_MAX, 0, 270);
+    host::start_log_capture();
+    EXPECT(c, rig.write_limits(19.0f, 29.0f, 190, 270) >= 1);
+    EXPECT(c, rig.write_limits(20.0f, 26.0f, 200, 260) == 1);
+    EXPECT(c, !logged_fallback(host::stop_log_capture()));
+  }
+
+  {
+    host::reset_clock();
+    Rig rig;
+    // Every attempt of the first merged write goes unanswered; single writes get through
+    rig.controller.drop_next_multi_writes(2);
+    host::start_log_capture();
+    EXPECT(c, rig.write_limits(19.0f, 27.0f, 190, 270) == 0);
+    EXPECT(c, rig.write_limits(20.0f, 26.0f, 200, 260) == 1);
+    EXPECT(c, rig.write_limits(21.0f, 25.0f, 210, 250) == 1);
+    EXPECT(c, !logged_fallback(host::stop_log_capture()));
+  }
+
+  return c.result("multi_write");
+}
@@ -0,0 +1,91 @@
+// Probe sweep schedule against the simulated controller: routine polls read only the status step and
+// the element block, and a channel gets its full read set when
+//   - the status word changes (the output bit aside, it flips with every heating cycle)
+//   - the channel was written
+//   - the last full read is older than full_read_interval (a change made on the controller panel is
+//     only picked up then)
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "loop_runner.h"
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint8_t CHANNELS = 2;
+static constexpr uint32_t UPDATE_MS = 5000;
+static constexpr uint32_t FULL_READ_INTERVAL_MS = 60000;
+static constexpr uint8_t STATUS = 0x00;
+
+struct Rig {
+  FakeController controller;
+  WavinAHC9000 hub;
+  LoopRunner runner;
+
+  Rig() {
+    for (uint8_t ch = 1; ch <= CHANNELS; ch++) {
+      this->controller.set_zone(ch, FakeController::Zone{});
+      this->hub.add_active_channel(ch);
+    }
+    this->hub.set_uart_parent(&this->controller);
+    this->hub.set_update_interval(UPDATE_MS);
+    this->hub.set_poll_channels_per_cycle(CHANNELS);
+    this->hub.set_identity_check_interval_ms(0);
+    this->hub.set_probe_sweep(true);
+    this->hub.set_full_read_interval_ms(FULL_READ_INTERVAL_MS);
+    this->runner.add(&this->hub);
+    this->runner.setup();
+  }
+
+  const ChannelState &channel(uint8_t ch) { return this->hub.get_state_view().channels.at(ch); }
+  // The floor limits step is skipped by a probe, so its read time marks the last full read set
+  uint32_t full_read_ms(uint8_t ch) { return this->channel(ch).field_read_ms(CHANGE_FLOOR_MIN); }
+};
+
+int main() {
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+  host::reset_clock();
+  Rig rig;
+
+  // Discovery, then probe sweeps only: one status and one element read per channel
+  rig.runner.run_for(20000);
+  const SweepStats &sweep = rig.hub.get_last_sweep_stats();
+  EXPECT(c, sweep.probe_sets == CHANNELS);
+  EXPECT(c, sweep.full_sets == 0);
+  EXPECT(c, sweep.transactions == 2u * CHANNELS);
+
+  // Heating starts on channel 1: the action follows, no full read
+  uint32_t full1 = rig.full_read_ms(1);
+  rig.controller.set_register(FakeController::CAT_CHANNELS, 0, STATUS, 0x0010);
+  rig.runner.run_for(UPDATE_MS + 1000);
+  EXPECT(c, rig.channel(1).action == climate::CLIMATE_ACTION_HEATING);
+  EXPECT(c, rig.full_read_ms(1) == full1);
+
+  // Any other status bit on channel 2 changes: full read of channel 2 only
+  uint32_t full2 = rig.full_read_ms(2);
+  rig.controller.set_register(FakeController::CAT_CHANNELS, 1, STATUS, 0x0001);
+  rig.runner.run_for(UPDATE_MS + 1000);
+  EXPECT(c, rig.full_read_ms(2) > full2);
+  EXPECT(c, rig.full_read_ms(1) == full1);
+
+  // A write to channel 2: verified at once, then read in full by the next routine poll
+  full2 = rig.full_read_ms(2);
+  rig.hub.write_channel_setpoint(2, 22.5f);
+  rig.runner.run_for(UPDATE_MS + 1000);
+  EXPECT(c, rig.full_read_ms(2) > full2);
+  EXPECT_NEAR(c, rig.channel(2).setpoint_c, 22.5f, 0.01f);
+  EXPECT(c, rig.full_read_ms(1) == full1);
+
+  // Setpoint changed on the panel of channel 1: invisible to the probe, read once the full read is due
+  rig.controller.set_register(FakeController::CAT_PACKED, 0, 0x00, 250);
+  rig.runner.run_for(UPDATE_MS + 1000);
+  EXPECT_NEAR(c, rig.channel(1).setpoint_c, 21.0f, 0.01f);
+  bool seen = rig.runner.run_for(FULL_READ_INTERVAL_MS, [&] { return rig.channel(1).setpoint_c > 24.9f; });
+  EXPECT(c, seen);
+  EXPECT(c, millis() - full1 >= FULL_READ_INTERVAL_MS);
+  EXPECT(c, millis() - full1 < FULL_READ_INTERVAL_MS + 2 * UPDATE_MS);
+
+  return c.result("probe_sweep");
+}
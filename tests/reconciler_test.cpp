@@ -0,0 +1,91 @@
+// Desired-state reconciler against the simulated controller:
+//   - a write lost on the bus is corrected by the verification read and converges
+//   - a value the controller never accepts (clamped) is retried RECONCILE_MAX_ATTEMPTS times, then
+//     given up: the scene reports the channel as failed and the bus goes quiet again
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "loop_runner.h"
+
+#include <string>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint8_t SETPOINT = 0x00;
+// WavinAHC9000::RECONCILE_MAX_ATTEMPTS
+static constexpr uint32_t MAX_CORRECTIONS = 3;
+
+struct Rig {
+  FakeController controller;
+  WavinAHC9000 hub;
+  LoopRunner runner;
+
+  Rig() {
+    this->controller.set_zone(1, FakeController::Zone{});
+    this->hub.set_uart_parent(&this->controller);
+    this->hub.add_active_channel(1);
+    this->runner.add(&this->hub);
+    this->runner.setup();
+    this->runner.run_for(10000, [this] { return this->hub.get_last_sweep_stats().transactions != 0; });
+  }
+};
+
+static bool logged(const std::vector<std::string> &lines, const char *text) {
+  for (const auto &line : lines) {
+    if (line.find(text) != std::string::npos) return true;
+  }
+  return false;
+}
+
+int main() {
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+
+  {
+    host::reset_clock();
+    Rig rig;
+    // Both attempts of the write go unanswered and unapplied
+    rig.controller.drop_next(2);
+    host::start_log_capture();
+    rig.hub.write_channel_setpoint(1, 23.5f);
+    bool landed = rig.runner.run_for(30000, [&] {
+      return rig.controller.get_register(FakeController::CAT_PACKED, 0, SETPOINT) == 235;
+    });
+    rig.runner.run_for(5000);
+    auto lines = host::stop_log_capture();
+    EXPECT(c, landed);
+    EXPECT(c, rig.controller.get_writes() == 1);
+    EXPECT(c, logged(lines, "converged"));
+    EXPECT(c, logged(lines, "(1 correction pass)"));
+    EXPECT_NEAR(c, rig.hub.get_state_view().channels.at(1).setpoint_c, 23.5f, 0.01f);
+  }
+
+  {
+    host::reset_clock();
+    Rig rig;
+    rig.controller.set_clamp(FakeController::CAT_PACKED, 0, SETPOINT, 50, 250);
+    uint32_t scenes = 0;
+    bool scene_ok = true;
+    rig.hub.add_on_scene_result_callback([&](uint32_t, uint8_t ch, bool ok) {
+      scenes++;
+      scene_ok = ok;
+    });
+    host::start_log_capture();
+    rig.hub.apply_scene({{1, FIELD_SETPOINT, 28.0f}});
+    rig.runner.run_for(30000, [&] { return scenes != 0; });
+    uint32_t writes = rig.controller.get_writes();
+    // Nothing left to reconcile: routine polls only from here on
+    rig.runner.run_for(60000);
+    auto lines = host::stop_log_capture();
+    EXPECT(c, scenes == 1);
+    EXPECT(c, !scene_ok);
+    EXPECT(c, writes == 1 + MAX_CORRECTIONS);
+    EXPECT(c, rig.controller.get_writes() == writes);
+    EXPECT(c, logged(lines, "giving up reconciliation after 3 passes"));
+    EXPECT(c, rig.controller.get_register(FakeController::CAT_PACKED, 0, SETPOINT) == 250);
+  }
+
+  return c.result("reconciler");
+}
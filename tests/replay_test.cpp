@@ -0,0 +1,169 @@
+// Replays a captured sweep (fixtures/*.trace, the dump_bus_trace() format) into the hub through the
+// replay UART and checks the decoded channel cache and what the entities published. The capture
+// includes a CRC error and a timeout, both retried successfully, so the retry path is replayed too.
+//
+//   replay_test <capture.trace>
+#include "wavin_ahc9000.h"
+#include "loop_runner.h"
+#include "replay_uart.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+// Continuation lines of long frames are joined back onto their frame
+static void check_capture_parser(Checks &c) {
+  std::istringstream in("+0000000000 TX OK 0143010000200000\n"
+                        "+0000070000 RX OK 00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff\n"
+                        "[I][wavin_ahc9000:915]:   ...032 a1a2a3\n"
+                        "+0000080000 TX OK 0143070200030000\n"
+                        "+0001080000 RX TO \n");
+  ReplayUart uart;
+  EXPECT(c, uart.load(in));
+  EXPECT(c, uart.get_exchanges().size() == 2);
+  if (uart.get_exchanges().size() != 2) return;
+  const auto &first = uart.get_exchanges()[0];
+  EXPECT(c, first.response.size() == 35);
+  EXPECT(c, first.response.back() == 0xa3);
+  EXPECT(c, first.delay_us == 70000);
+  EXPECT(c, uart.get_exchanges()[1].timed_out);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <capture.trace>\n", argv[0]);
+    return 2;
+  }
+  Checks c;
+  check_capture_parser(c);
+
+  ReplayUart uart;
+  std::ifstream file(argv[1]);
+  if (!uart.load(file)) {
+    std::fprintf(stderr, "no exchanges in %s\n", argv[1]);
+    return 2;
+  }
+
+  WavinAHC9000 hub;
+  hub.set_uart_parent(&uart);
+  hub.add_active_channel(1);
+  hub.add_active_channel(2);
+
+  WavinZoneClimate climate1, climate2, group;
+  for (auto *cl : {&climate1, &climate2, &group}) cl->set_parent(&hub);
+  climate1.set_single_channel(1);
+  climate2.set_single_channel(2);
+  group.set_members({1, 2});
+  hub.add_channel_climate(&climate1);
+  hub.add_channel_climate(&climate2);
+  hub.add_group_climate(&group);
+
+  sensor::Sensor temp1, temp2, floor1, battery1, battery2, rssi_elem1, rssi_cu1, setpoint1, floor_min1, floor_max1;
+  hub.add_channel_temperature_sensor(1, &temp1);
+  hub.add_channel_temperature_sensor(2, &temp2);
+  hub.add_channel_floor_temperature_sensor(1, &floor1);
+  hub.add_channel_battery_sensor(1, &battery1);
+  hub.add_channel_battery_sensor(2, &battery2);
+  hub.add_channel_rssi_element_sensor(1, &rssi_elem1);
+  hub.add_channel_rssi_cu_sensor(1, &rssi_cu1);
+  hub.add_channel_comfort_setpoint_sensor(1, &setpoint1);
+  hub.add_channel_floor_min_temperature_sensor(1, &floor_min1);
+  hub.add_channel_floor_max_temperature_sensor(1, &floor_max1);
+  binary_sensor::BinarySensor output1, output2;
+  hub.add_channel_output_binary_sensor(1, &output1);
+  hub.add_channel_output_binary_sensor(2, &output2);
+  WavinSwitch lock1, standby2;
+  lock1.set_type(WavinSwitch::CHILD_LOCK);
+  standby2.set_type(WavinSwitch::STANDBY);
+  hub.add_channel_child_lock_switch(1, &lock1);
+  hub.add_channel_standby_switch(2, &standby2);
+  text_sensor::TextSensor hw, sw, name;
+  hub.set_hardware_version_sensor(&hw);
+  hub.set_software_version_sensor(&sw);
+  hub.set_device_name_sensor(&name);
+
+  LoopRunner runner;
+  runner.add(&hub);
+  runner.setup();
+  // Discovery reads both channels; give the paced publishing time to drain
+  bool swept = runner.run_for(10000, [&] { return hub.get_last_sweep_stats().transactions != 0; });
+  runner.run_for(2000);
+  EXPECT(c, swept);
+  EXPECT(c, uart.get_unmatched().empty());
+  EXPECT(c, uart.get_used() == uart.get_exchanges().size());
+
+  const SweepStats &sweep = hub.get_last_sweep_stats();
+  EXPECT(c, sweep.crc_errors == 1);
+  EXPECT(c, sweep.timeouts == 1);
+
+  auto view = hub.get_state_view();
+  EXPECT(c, view.channels.count(1) == 1 && view.channels.count(2) == 1);
+  const ChannelState &ch1 = view.channels.at(1);
+  EXPECT(c, ch1.is_consistent());
+  EXPECT(c, ch1.read_clean);
+  EXPECT(c, ch1.refreshed_ms != 0);
+  EXPECT(c, ch1.primary_index == 1);
+  EXPECT_NEAR(c, ch1.current_temp_c, 21.5f, 0.01f);
+  EXPECT_NEAR(c, ch1.floor_temp_c, 23.4f, 0.01f);
+  EXPECT(c, ch1.has_floor_sensor);
+  EXPECT_NEAR(c, ch1.setpoint_c, 22.0f, 0.01f);
+  EXPECT_NEAR(c, ch1.standby_setpoint_c, 16.0f, 0.01f);
+  EXPECT_NEAR(c, ch1.hysteresis_c, 0.3f, 0.01f);
+  EXPECT_NEAR(c, ch1.floor_min_c, 19.0f, 0.01f);
+  EXPECT_NEAR(c, ch1.floor_max_c, 27.0f, 0.01f);
+  EXPECT(c, ch1.mode == climate::CLIMATE_MODE_HEAT);
+  EXPECT(c, ch1.action == climate::CLIMATE_ACTION_HEATING);
+  EXPECT(c, ch1.child_lock);
+  EXPECT(c, ch1.battery_pct == 80);
+  EXPECT_NEAR(c, ch1.rssi_element_dbm, -62.0f, 0.01f);
+  EXPECT_NEAR(c, ch1.rssi_cu_dbm, -64.0f, 0.01f);
+
+  const ChannelState &ch2 = view.channels.at(2);
+  EXPECT(c, ch2.read_clean);
+  EXPECT_NEAR(c, ch2.current_temp_c, 19.8f, 0.01f);
+  EXPECT(c, std::isnan(ch2.floor_temp_c));
+  EXPECT(c, !ch2.has_floor_sensor);
+  EXPECT_NEAR(c, ch2.setpoint_c, 20.5f, 0.01f);
+  EXPECT_NEAR(c, ch2.standby_setpoint_c, 15.0f, 0.01f);
+  EXPECT(c, ch2.mode == climate::CLIMATE_MODE_OFF);
+  EXPECT(c, ch2.action == climate::CLIMATE_ACTION_IDLE);
+  EXPECT(c, !ch2.child_lock);
+  EXPECT(c, ch2.battery_pct == 30);
+  EXPECT_NEAR(c, ch2.rssi_element_dbm, -78.0f, 0.01f);
+  EXPECT_NEAR(c, ch2.rssi_cu_dbm, -72.0f, 0.01f);
+
+  // Published entity states
+  EXPECT_NEAR(c, temp1.state, 21.5f, 0.01f);
+  EXPECT_NEAR(c, temp2.state, 19.8f, 0.01f);
+  EXPECT_NEAR(c, floor1.state, 23.4f, 0.01f);
+  EXPECT_NEAR(c, battery1.state, 80.0f, 0.01f);
+  EXPECT_NEAR(c, battery2.state, 30.0f, 0.01f);
+  EXPECT_NEAR(c, rssi_elem1.state, -62.0f, 0.01f);
+  EXPECT_NEAR(c, rssi_cu1.state, -64.0f, 0.01f);
+  EXPECT_NEAR(c, setpoint1.state, 22.0f, 0.01f);
+  EXPECT_NEAR(c, floor_min1.state, 19.0f, 0.01f);
+  EXPECT_NEAR(c, floor_max1.state, 27.0f, 0.01f);
+  EXPECT(c, output1.has_state() && output1.state);
+  EXPECT(c, output2.has_state() && !output2.state);
+  EXPECT(c, lock1.get_publish_count() > 0 && lock1.state);
+  EXPECT(c, standby2.get_publish_count() > 0 && standby2.state);
+  EXPECT(c, hw.state == "MC1102");
+  EXPECT(c, sw.state == "MC61018");
+  EXPECT(c, name.state == "AC-116");
+
+  EXPECT(c, climate1.get_publish_count() > 0);
+  EXPECT_NEAR(c, climate1.current_temperature, 21.5f, 0.01f);
+  EXPECT_NEAR(c, climate1.target_temperature, 22.0f, 0.01f);
+  EXPECT(c, climate1.mode == climate::CLIMATE_MODE_HEAT);
+  EXPECT(c, climate1.action == climate::CLIMATE_ACTION_HEATING);
+  EXPECT(c, climate2.mode == climate::CLIMATE_MODE_OFF);
+  EXPECT_NEAR(c, climate2.target_temperature, 20.5f, 0.01f);
+  EXPECT_NEAR(c, group.current_temperature, 20.65f, 0.01f);
+  EXPECT_NEAR(c, group.target_temperature, 21.25f, 0.01f);
+  EXPECT(c, group.mode == climate::CLIMATE_MODE_HEAT);
+
+  return c.result("replay");
+}
@@ -0,0 +1,105 @@
+// Controller resync against the simulated controller, with probe sweeps and a long full read interval
+// so that routine polls leave the floor limits alone:
+//   - a floor limit changed on the panel stays unseen while the identity holds
+//   - a swapped controller (new software version) is caught by the periodic identity check and every
+//     channel is read in full again, well before its full read would be due
+//   - a controller that stops answering and comes back is resynced as well
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "loop_runner.h"
+
+#include <string>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint8_t CHANNELS = 2;
+static constexpr uint32_t UPDATE_MS = 5000;
+static constexpr uint32_t IDENTITY_CHECK_MS = 30000;
+static constexpr uint32_t FULL_READ_INTERVAL_MS = 600000;
+static constexpr uint8_t FLOOR_MIN = 0x0A;
+
+struct Rig {
+  FakeController controller;
+  WavinAHC9000 hub;
+  LoopRunner runner;
+
+  Rig() {
+    for (uint8_t ch = 1; ch <= CHANNELS; ch++) {
+      this->controller.set_zone(ch, FakeController::Zone{});
+      this->hub.add_active_channel(ch);
+    }
+    this->hub.set_uart_parent(&this->controller);
+    this->hub.set_update_interval(UPDATE_MS);
+    this->hub.set_poll_channels_per_cycle(CHANNELS);
+    this->hub.set_identity_check_interval_ms(IDENTITY_CHECK_MS);
+    this->hub.set_probe_sweep(true);
+    this->hub.set_full_read_interval_ms(FULL_READ_INTERVAL_MS);
+    this->runner.add(&this->hub);
+    this->runner.setup();
+  }
+
+  const ChannelState &channel(uint8_t ch) { return this->hub.get_state_view().channels.at(ch); }
+  // The floor limits step is skipped by a probe, so its read time marks the last full read set
+  uint32_t full_read_ms(uint8_t ch) { return this->channel(ch).field_read_ms(CHANGE_FLOOR_MIN); }
+};
+
+static bool logged(const std::vector<std::string> &lines, const char *text) {
+  for (const auto &line : lines) {
+    if (line.find(text) != std::string::npos) return true;
+  }
+  return false;
+}
+
+int main() {
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+  host::reset_clock();
+  Rig rig;
+
+  // Discovery, then probe sweeps only
+  rig.runner.run_for(20000);
+  EXPECT(c, rig.hub.get_last_sweep_stats().full_sets == 0);
+  EXPECT(c, rig.hub.get_resync_count() == 0);
+
+  // Same controller, floor limit changed on the panel: not read until the full read is due
+  rig.controller.set_register(FakeController::CAT_PACKED, 0, FLOOR_MIN, 155);
+  rig.runner.run_for(2 * IDENTITY_CHECK_MS);
+  EXPECT_NEAR(c, rig.channel(1).floor_min_c, 18.0f, 0.01f);
+  EXPECT(c, rig.hub.get_resync_count() == 0);
+
+  // Controller swapped: the next identity check resyncs every channel
+  uint32_t full1 = rig.full_read_ms(1);
+  uint32_t full2 = rig.full_read_ms(2);
+  rig.controller.set_identity(0x0082, 0x0190, 117);
+  host::start_log_capture();
+  bool seen = rig.runner.run_for(IDENTITY_CHECK_MS + 2 * UPDATE_MS,
+                                 [&] { return std::fabs(rig.channel(1).floor_min_c - 15.5f) < 0.01f; });
+  rig.runner.run_for(UPDATE_MS);
+  auto lines = host::stop_log_capture();
+  EXPECT(c, seen);
+  EXPECT(c, logged(lines, "Controller identity changed"));
+  EXPECT(c, rig.hub.get_resync_count() == 1);
+  EXPECT(c, rig.full_read_ms(1) > full1);
+  EXPECT(c, rig.full_read_ms(2) > full2);
+
+  // Unchanged identity on the following checks: no further resync
+  rig.runner.run_for(2 * IDENTITY_CHECK_MS);
+  EXPECT(c, rig.hub.get_resync_count() == 1);
+
+  // The controller stops answering, then comes back: resynced once it answers
+  rig.controller.set_silent(true);
+  rig.runner.run_for(4 * UPDATE_MS);
+  full2 = rig.full_read_ms(2);
+  rig.controller.set_silent(false);
+  host::start_log_capture();
+  rig.runner.run_for(4 * UPDATE_MS);
+  lines = host::stop_log_capture();
+  EXPECT(c, logged(lines, "Controller answering again after an outage"));
+  EXPECT(c, rig.hub.get_resync_count() == 2);
+  EXPECT(c, rig.full_read_ms(2) > full2);
+
+  return c.result("resync");
+}
@@ -0,0 +1,107 @@
+// Scenes against the simulated controller, polled rarely enough that routine reads stay out of the way:
+//   - after discovery, every write goes out first and each channel is verified once, reading only
+//     the step that holds the changed field; every channel is reported as converged
+//   - a scene applied before discovery ran: the verification replaces the queued discovery read,
+//     so it has to be a full read set, or the channel stays half read until its routine poll
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "loop_runner.h"
+
+#include <map>
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint8_t CHANNELS = 4;
+static constexpr uint8_t SETPOINT = 0x00;
+
+struct Rig {
+  FakeController controller;
+  WavinAHC9000 hub;
+  LoopRunner runner;
+  std::map<uint8_t, bool> results;
+
+  Rig() {
+    for (uint8_t ch = 1; ch <= CHANNELS; ch++) {
+      this->controller.set_zone(ch, FakeController::Zone{});
+      this->hub.add_active_channel(ch);
+    }
+    this->hub.set_uart_parent(&this->controller);
+    this->hub.set_update_interval(300000);
+    this->hub.set_identity_check_interval_ms(0);
+    this->hub.add_on_scene_result_callback([this](uint32_t, uint8_t ch, bool ok) { this->results[ch] = ok; });
+    this->runner.add(&this->hub);
+    this->runner.setup();
+  }
+
+  uint32_t apply_setback(float celsius) {
+    std::vector<WavinAHC9000::SceneChange> changes;
+    for (uint8_t ch = 1; ch <= CHANNELS; ch++) changes.push_back({ch, FIELD_SETPOINT, celsius});
+    this->results.clear();
+    return this->hub.apply_scene(changes);
+  }
+
+  bool all_ok() const {
+    if (this->results.size() != CHANNELS) return false;
+    for (const auto &kv : this->results) {
+      if (!kv.second) return false;
+    }
+    return true;
+  }
+};
+
+int main() {
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+
+  {
+    host::reset_clock();
+    Rig rig;
+    auto discovered = [&] {
+      const auto &view = rig.hub.get_state_view();
+      for (uint8_t ch = 1; ch <= CHANNELS; ch++) {
+        auto it = view.channels.find(ch);
+        if (it == view.channels.end() || it->second.field_read_ms(CHANGE_TEMPERATURE) == 0) return false;
+      }
+      return true;
+    };
+    EXPECT(c, rig.runner.run_for(20000, discovered));
+    uint32_t requests = rig.controller.get_requests();
+    uint32_t writes = rig.controller.get_writes();
+    uint32_t start = millis();
+    rig.apply_setback(17.0f);
+    EXPECT(c, rig.runner.run_for(20000, [&] { return rig.results.size() == CHANNELS; }));
+    uint32_t took = millis() - start;
+    EXPECT(c, rig.all_ok());
+    EXPECT(c, rig.controller.get_writes() - writes == CHANNELS);
+    // Per channel one write and the setpoint step (two spans); a full read set would be six reads
+    EXPECT(c, rig.controller.get_requests() - requests == 3u * CHANNELS);
+    EXPECT(c, took < 2000);
+    for (uint8_t ch = 1; ch <= CHANNELS; ch++)
+      EXPECT(c, rig.controller.get_register(FakeController::CAT_PACKED, ch - 1, SETPOINT) == 170);
+  }
+
+  {
+    host::reset_clock();
+    Rig rig;
+    rig.apply_setback(17.0f);
+    EXPECT(c, rig.runner.run_for(20000, [&] { return rig.results.size() == CHANNELS; }));
+    EXPECT(c, rig.all_ok());
+    // Well before the first routine poll, every channel has been read in full
+    rig.runner.run_for(5000);
+    const auto &view = rig.hub.get_state_view();
+    for (uint8_t ch = 1; ch <= CHANNELS; ch++) {
+      auto it = view.channels.find(ch);
+      EXPECT(c, it != view.channels.end());
+      if (it == view.channels.end()) continue;
+      EXPECT(c, it->second.field_read_ms(CHANGE_TEMPERATURE) != 0);
+      EXPECT(c, it->second.field_read_ms(CHANGE_FLOOR_MIN) != 0);
+      EXPECT(c, it->second.field_read_ms(CHANGE_MODE) != 0);
+      EXPECT_NEAR(c, it->second.setpoint_c, 17.0f, 0.01f);
+    }
+  }
+
+  return c.result("scene");
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor : public EntityBase {
+ public:
+  bool state{false};
+  void publish_state(bool state) {
+    this->state = state;
+    this->publish_count_++;
+  }
+  bool has_state() const { return this->publish_count_ != 0; }
+  uint32_t get_publish_count() const { return this->publish_count_; }
+
+ protected:
+  uint32_t publish_count_{0};
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
@@ -0,0 +1,76 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace climate {
+
+enum ClimateMode : uint8_t { CLIMATE_MODE_OFF = 0, CLIMATE_MODE_HEAT_COOL = 1, CLIMATE_MODE_COOL = 2, CLIMATE_MODE_HEAT = 3 };
+enum ClimateAction : uint8_t {
+  CLIMATE_ACTION_OFF = 0,
+  CLIMATE_ACTION_COOLING = 2,
+  CLIMATE_ACTION_HEATING = 3,
+  CLIMATE_ACTION_IDLE = 4,
+};
+
+class ClimateTraits {
+ public:
+  void set_supported_modes(std::set<ClimateMode> modes) { this->modes_ = std::move(modes); }
+  [[deprecated]] void set_supports_current_temperature(bool) {}
+  [[deprecated]] void set_supports_action(bool) {}
+  [[deprecated]] void set_supports_two_point_target_temperature(bool) {}
+  void set_visual_min_temperature(float) {}
+  void set_visual_max_temperature(float) {}
+  void set_visual_temperature_step(float) {}
+
+ protected:
+  std::set<ClimateMode> modes_;
+};
+
+class ClimateCall {
+ public:
+  ClimateCall &set_mode(ClimateMode mode) {
+    this->mode_ = mode;
+    return *this;
+  }
+  ClimateCall &set_target_temperature(float t) {
+    this->target_temperature_ = t;
+    return *this;
+  }
+  const std::optional<ClimateMode> &get_mode() const { return this->mode_; }
+  const std::optional<float> &get_target_temperature() const { return this->target_temperature_; }
+  const std::optional<float> &get_target_temperature_low() const { return this->target_temperature_low_; }
+  const std::optional<float> &get_target_temperature_high() const { return this->target_temperature_high_; }
+
+ protected:
+  std::optional<ClimateMode> mode_;
+  std::optional<float> target_temperature_;
+  std::optional<float> target_temperature_low_;
+  std::optional<float> target_temperature_high_;
+};
+
+class Climate : public EntityBase {
+ public:
+  ClimateMode mode{CLIMATE_MODE_OFF};
+  ClimateAction action{CLIMATE_ACTION_OFF};
+  float current_temperature{NAN};
+  float target_temperature{NAN};
+  float target_temperature_low{NAN};
+  float target_temperature_high{NAN};
+
+  void publish_state() { this->publish_count_++; }
+  uint32_t get_publish_count() const { return this->publish_count_; }
+  // Runs control() the way a frontend call would
+  void make_call(const ClimateCall &call) { this->control(call); }
+
+ protected:
+  virtual ClimateTraits traits() = 0;
+  virtual void control(const ClimateCall &call) = 0;
+  uint32_t publish_count_{0};
+};
+
+}  // namespace climate
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace sensor {
+
+class Sensor : public EntityBase {
+ public:
+  float state{NAN};
+  void publish_state(float state) {
+    this->state = state;
+    this->publish_count_++;
+  }
+  bool has_state() const { return this->publish_count_ != 0; }
+  uint32_t get_publish_count() const { return this->publish_count_; }
+
+ protected:
+  uint32_t publish_count_{0};
+};
+
+}  // namespace sensor
+}  // namespace esphome
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace switch_ {
+
+class Switch : public EntityBase {
+ public:
+  bool state{false};
+  void publish_state(bool state) {
+    this->state = state;
+    this->publish_count_++;
+  }
+  void turn_on() { this->write_state(true); }
+  void turn_off() { this->write_state(false); }
+  uint32_t get_publish_count() const { return this->publish_count_; }
+
+ protected:
+  virtual void write_state(bool state) = 0;
+  uint32_t publish_count_{0};
+};
+
+}  // namespace switch_
+}  // namespace esphome
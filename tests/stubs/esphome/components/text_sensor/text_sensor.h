@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase {
+ public:
+  std::string state;
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->publish_count_++;
+  }
+  bool has_state() const { return this->publish_count_ != 0; }
+  uint32_t get_publish_count() const { return this->publish_count_; }
+
+ protected:
+  uint32_t publish_count_{0};
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
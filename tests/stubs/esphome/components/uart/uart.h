@@ -0,0 +1,45 @@
+#pragma once
+// Host stand-in for the UART component. UARTDevice forwards to a UARTComponent parent like the real
+// one does; tests provide the parent (simulated controller, capture replay, fault shim).
+#include <cstddef>
+#include <cstdint>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace uart {
+
+class UARTComponent {
+ public:
+  virtual ~UARTComponent() = default;
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual bool read_byte(uint8_t *data) = 0;
+  virtual int available() = 0;
+  virtual void flush() {}
+  void set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
+  uint32_t get_baud_rate() const { return this->baud_rate_; }
+
+ protected:
+  uint32_t baud_rate_{9600};
+};
+
+class UARTDevice {
+ public:
+  UARTDevice() = default;
+  explicit UARTDevice(UARTComponent *parent) : parent_(parent) {}
+  void set_uart_parent(UARTComponent *parent) { this->parent_ = parent; }
+
+  void write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
+  bool read_byte(uint8_t *data) { return this->parent_->read_byte(data); }
+  int read() {
+    uint8_t data;
+    return this->read_byte(&data) ? data : -1;
+  }
+  int available() { return this->parent_->available(); }
+  void flush() { this->parent_->flush(); }
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual void on_shutdown() {}
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() = default;
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+  virtual void update() = 0;
+  void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  uint32_t get_update_interval() const { return this->update_interval_; }
+
+ protected:
+  uint32_t update_interval_{5000};
+};
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() = default;
+  virtual void digital_write(bool value) = 0;
+};
+
+class EntityBase {
+ public:
+  void set_name(const std::string &name) { this->name_ = name; }
+  const std::string &get_name() const { return this->name_; }
+
+ protected:
+  std::string name_;
+};
+
+}  // namespace esphome
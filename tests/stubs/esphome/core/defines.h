@@ -0,0 +1,2 @@
+#pragma once
+// Host builds pass the component's WAVIN_AHC9000_* defines on the compiler command line
@@ -0,0 +1,14 @@
+#pragma once
+// Host stand-in for esphome/core/hal.h. Time comes from the host clock in host.h: simulated by
+// default (delay() advances it instantly), or the real monotonic clock for threaded tests.
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+}  // namespace esphome
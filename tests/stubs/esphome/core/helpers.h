@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+
+// Seeded and reproducible on host, see host::seed_random()
+uint32_t random_uint32();
+float random_float();
+
+}  // namespace esphome
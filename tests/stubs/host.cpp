@@ -0,0 +1,92 @@
+#include "host.h"
+#include "esphome/core/application.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace esphome {
+
+Application App;  // NOLINT
+
+namespace host {
+
+static std::atomic<int> clock_mode{CLOCK_SIMULATED};
+static std::atomic<uint64_t> sim_us{0};
+static const auto real_epoch = std::chrono::steady_clock::now();
+
+void set_clock_mode(ClockMode mode) { clock_mode = mode; }
+ClockMode get_clock_mode() { return (ClockMode) clock_mode.load(); }
+
+uint64_t now_us() {
+  if (clock_mode == CLOCK_SIMULATED) return sim_us;
+  return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - real_epoch)
+      .count();
+}
+
+void advance_us(uint64_t us) {
+  if (clock_mode == CLOCK_SIMULATED) {
+    sim_us += us;
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+}
+
+void reset_clock() { sim_us = 0; }
+
+static std::mutex log_lock;
+static int log_level = ESPHOME_LOG_LEVEL_WARN;
+static bool capturing = false;
+static std::vector<std::string> captured;
+
+void set_log_level(int level) { log_level = level; }
+void start_log_capture() {
+  std::lock_guard<std::mutex> guard(log_lock);
+  captured.clear();
+  capturing = true;
+}
+std::vector<std::string> stop_log_capture() {
+  std::lock_guard<std::mutex> guard(log_lock);
+  capturing = false;
+  return std::move(captured);
+}
+
+static std::mt19937 rng(1);
+static std::mutex rng_lock;
+void seed_random(uint32_t seed) {
+  std::lock_guard<std::mutex> guard(rng_lock);
+  rng.seed(seed);
+}
+
+}  // namespace host
+
+uint32_t millis() { return (uint32_t) (host::now_us() / 1000); }
+uint32_t micros() { return (uint32_t) host::now_us(); }
+void delay(uint32_t ms) { host::advance_us((uint64_t) ms * 1000); }
+void delayMicroseconds(uint32_t us) { host::advance_us(us); }
+
+uint32_t random_uint32() {
+  std::lock_guard<std::mutex> guard(host::rng_lock);
+  return host::rng();
+}
+float random_float() { return (float) (random_uint32() >> 8) / (float) (1u << 24); }
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {  // NOLINT
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  std::lock_guard<std::mutex> guard(host::log_lock);
+  if (host::capturing) host::captured.emplace_back(buf);
+  static const char LEVELS[] = "-EWICDV";
+  if (level <= host::log_level) fprintf(stderr, "[%c][%s:%d]: %s\n", LEVELS[level], tag, line, buf);
+}
+
+}  // namespace esphome
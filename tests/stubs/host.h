@@ -0,0 +1,29 @@
+#pragma once
+// Controls for the host stand-ins of the ESPHome runtime (clock, logging, random numbers)
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace host {
+
+// SIMULATED: time only moves through delay()/delayMicroseconds() and advance_us(), so runs are
+// deterministic and fast. REAL: the monotonic clock, and delay() sleeps; for threaded tests.
+enum ClockMode { CLOCK_SIMULATED, CLOCK_REAL };
+void set_clock_mode(ClockMode mode);
+ClockMode get_clock_mode();
+uint64_t now_us();
+void advance_us(uint64_t us);
+// Back to boot (simulated clock only), for runs that each stand for a fresh device
+void reset_clock();
+
+// Lines at or below the level are printed to stderr (default WARN)
+void set_log_level(int level);
+// Captures every formatted line regardless of level until stop_log_capture()
+void start_log_capture();
+std::vector<std::string> stop_log_capture();
+
+void seed_random(uint32_t seed);
+
+}  // namespace host
+}  // namespace esphome
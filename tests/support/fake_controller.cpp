@@ -0,0 +1,155 @@
+#include "fake_controller.h"
+#include "crc16.h"
+#include "host.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace wavinahc9000v3 {
+namespace testing {
+
+static constexpr uint8_t DEVICE_ADDR = 0x01;
+static constexpr uint8_t FC_READ = 0x43;
+static constexpr uint8_t FC_WRITE = 0x44;
+static constexpr uint8_t FC_WRITE_MASKED = 0x45;
+
+void append_crc(std::vector<uint8_t> &frame) {
+  uint16_t crc = crc16(frame.data(), frame.size());
+  frame.push_back((uint8_t) (crc & 0xFF));
+  frame.push_back((uint8_t) (crc >> 8));
+}
+
+static uint16_t tenths(float c) { return (uint16_t) std::lround(c * 10.0f); }
+
+FakeController::FakeController() { this->set_identity(0x0082, 0x0180, 116); }
+
+void FakeController::set_register(uint8_t category, uint8_t page, uint8_t index, uint16_t value) {
+  this->registers_[key(category, page, index)] = value;
+}
+
+uint16_t FakeController::get_register(uint8_t category, uint8_t page, uint8_t index) const {
+  auto it = this->registers_.find(key(category, page, index));
+  return it == this->registers_.end() ? 0 : it->second;
+}
+
+void FakeController::set_zone(uint8_t channel, const Zone &zone) {
+  uint8_t page = (uint8_t) (channel - 1);
+  uint8_t element = channel;  // primary element index, 1-based
+  this->set_register(CAT_CHANNELS, page, 0, zone.heating ? 0x0010 : 0x0000);
+  this->set_register(CAT_CHANNELS, page, 1, 0);
+  this->set_register(CAT_CHANNELS, page, 2, element);
+  for (uint8_t i = 0; i < 0x10; i++) this->set_register(CAT_PACKED, page, i, 0);
+  this->set_register(CAT_PACKED, page, 0x00, tenths(zone.setpoint_c));
+  this->set_register(CAT_PACKED, page, 0x04, tenths(zone.standby_c));
+  this->set_register(CAT_PACKED, page, 0x07, (uint16_t) (0x4000 | (zone.standby ? 0x0001 : 0) | (zone.child_lock ? 0x0800 : 0)));
+  this->set_register(CAT_PACKED, page, 0x0A, tenths(zone.floor_min_c));
+  this->set_register(CAT_PACKED, page, 0x0B, tenths(zone.floor_max_c));
+  this->set_register(CAT_PACKED, page, 0x0E, tenths(zone.hysteresis_c));
+  uint8_t epage = (uint8_t) (element - 1);
+  for (uint8_t i = 0; i < 0x0B; i++) this->set_register(CAT_ELEMENTS, epage, i, 0);
+  this->set_register(CAT_ELEMENTS, epage, 0x04, tenths(zone.air_c));
+  this->set_register(CAT_ELEMENTS, epage, 0x05, std::isnan(zone.floor_c) ? 0 : tenths(zone.floor_c));
+  this->set_register(CAT_ELEMENTS, epage, 0x09, (uint16_t) (((uint8_t) zone.rssi_element << 8) | (uint8_t) zone.rssi_cu));
+  this->set_register(CAT_ELEMENTS, epage, 0x0A, zone.battery_steps);
+}
+
+void FakeController::set_identity(uint16_t hw, uint16_t sw, uint16_t name) {
+  this->set_register(CAT_INFO, 0, 0x02, hw);
+  this->set_register(CAT_INFO, 0, 0x03, sw);
+  this->set_register(CAT_INFO, 0, 0x04, name);
+}
+
+void FakeController::set_clamp(uint8_t category, uint8_t page, uint8_t index, uint16_t lo, uint16_t hi) {
+  this->clamps_[key(category, page, index)] = {lo, hi};
+}
+
+void FakeController::write_array(const uint8_t *data, size_t len) {
+  // The request is on the wire until flush() returns; the answer follows the turnaround time
+  uint64_t start = std::max(host::now_us(), this->tx_done_us_);
+  this->tx_done_us_ = start + len * this->byte_us();
+  this->handle_request(std::vector<uint8_t>(data, data + len));
+}
+
+void FakeController::flush() {
+  uint64_t now = host::now_us();
+  if (this->tx_done_us_ > now) host::advance_us(this->tx_done_us_ - now);
+}
+
+void FakeController::handle_request(const std::vector<uint8_t> &req) {
+  if (req.size() < 8 || req[0] != DEVICE_ADDR || crc16(req.data(), req.size()) != 0) return;
+  this->requests_++;
+  if (this->silent_) return;
+  if (this->drop_next_ > 0) {
+    this->drop_next_--;
+    return;
+  }
+  uint8_t fc = req[1], category = req[2], index = req[3], page = req[4], count = req[5];
+  std::vector<uint8_t> resp{DEVICE_ADDR, fc};
+  if (fc == FC_READ) {
+    resp.push_back((uint8_t) (2 * count));
+    for (uint8_t i = 0; i < count; i++) {
+      auto it = this->registers_.find(key(category, page, (uint8_t) (index + i)));
+      if (it == this->registers_.end()) return;
+      resp.push_back((uint8_t) (it->second >> 8));
+      resp.push_back((uint8_t) (it->second & 0xFF));
+    }
+  } else if (fc == FC_WRITE && req.size() == 8u + 2u * count) {
+    if (count > 1 && this->drop_multi_writes_ > 0) {
+      this->drop_multi_writes_--;
+      return;
+    }
+    this->writes_++;
+    if (count > 1) this->multi_writes_++;
+    uint8_t applied = this->multi_write_ ? count : 1;
+    for (uint8_t i = 0; i < applied; i++) {
+      uint32_t k = key(category, page, (uint8_t) (index + i));
+      uint16_t value = (uint16_t) ((req[6 + 2 * i] << 8) | req[7 + 2 * i]);
+      auto clamp = this->clamps_.find(k);
+      if (clamp != this->clamps_.end()) value = std::min(std::max(value, clamp->second.first), clamp->second.second);
+      this->registers_[k] = value;
+    }
+    resp.push_back(0);
+  } else if (fc == FC_WRITE_MASKED && req.size() == 12) {
+    this->writes_++;
+    uint16_t and_mask = (uint16_t) ((req[6] << 8) | req[7]);
+    uint16_t or_mask = (uint16_t) ((req[8] << 8) | req[9]);
+    uint16_t &reg = this->registers_[key(category, page, index)];
+    reg = (uint16_t) ((reg & and_mask) | or_mask);
+    resp.push_back(0);
+  } else {
+    return;
+  }
+  this->respond(std::move(resp));
+}
+
+void FakeController::respond(std::vector<uint8_t> frame) {
+  append_crc(frame);
+  uint64_t t = this->tx_done_us_ + this->turnaround_us_;
+  for (uint8_t b : frame) this->pending_.emplace_back(t += this->byte_us(), b);
+}
+
+void FakeController::release_ready() {
+  uint64_t now = host::now_us();
+  while (!this->pending_.empty() && this->pending_.front().first <= now) {
+    this->rx_.push_back(this->pending_.front().second);
+    this->pending_.pop_front();
+  }
+}
+
+bool FakeController::read_byte(uint8_t *data) {
+  this->release_ready();
+  if (this->rx_.empty()) return false;
+  *data = this->rx_.front();
+  this->rx_.pop_front();
+  return true;
+}
+
+int FakeController::available() {
+  this->release_ready();
+  return (int) this->rx_.size();
+}
+
+}  // namespace testing
+}  // namespace wavinahc9000v3
+}  // namespace esphome
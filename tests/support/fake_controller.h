@@ -0,0 +1,99 @@
+#pragma once
+// Simulated AHC 9000 on the far end of the host UART stand-in. Answers FC_READ, FC_WRITE and
+// FC_WRITE_MASKED from a register map, with bytes becoming readable at the pace of the configured
+// baud rate on the host clock. Reads of registers that were never set go unanswered, like spans
+// past the end of a block on the real controller.
+#include "esphome/components/uart/uart.h"
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace esphome {
+namespace wavinahc9000v3 {
+namespace testing {
+
+class FakeController : public uart::UARTComponent {
+ public:
+  static constexpr uint8_t CAT_ELEMENTS = 0x01;
+  static constexpr uint8_t CAT_PACKED = 0x02;
+  static constexpr uint8_t CAT_CHANNELS = 0x03;
+  static constexpr uint8_t CAT_INFO = 0x07;
+
+  FakeController();
+
+  void set_register(uint8_t category, uint8_t page, uint8_t index, uint16_t value);
+  uint16_t get_register(uint8_t category, uint8_t page, uint8_t index) const;
+  // One thermostat per channel: channel ch uses element ch (element page ch - 1)
+  struct Zone {
+    float air_c{21.0f};
+    float floor_c{NAN};     // NAN = no floor probe
+    float setpoint_c{21.0f};
+    float standby_c{16.0f};
+    float floor_min_c{18.0f};
+    float floor_max_c{28.0f};
+    float hysteresis_c{0.5f};
+    bool heating{false};
+    bool standby{false};
+    bool child_lock{false};
+    uint8_t battery_steps{10};    // 0..10
+    int8_t rssi_element{24};      // raw: -74 dBm + 0.5 dBm per step
+    int8_t rssi_cu{20};
+  };
+  void set_zone(uint8_t channel, const Zone &zone);
+  void set_identity(uint16_t hw, uint16_t sw, uint16_t name);
+
+  // FC_WRITE with count > 1 applies only the first register when false (older firmware)
+  void set_multi_write_supported(bool supported) { this->multi_write_ = supported; }
+  // Writes to this register are clamped to [lo, hi]
+  void set_clamp(uint8_t category, uint8_t page, uint8_t index, uint16_t lo, uint16_t hi);
+  // Unplugged or powered off: requests are ignored
+  void set_silent(bool silent) { this->silent_ = silent; }
+  // Drops the next n requests without an answer (a lost request or ACK)
+  void drop_next(uint32_t n) { this->drop_next_ = n; }
+  // Drops the next n multi-register writes without applying or answering them
+  void drop_next_multi_writes(uint32_t n) { this->drop_multi_writes_ = n; }
+  void set_turnaround_us(uint32_t us) { this->turnaround_us_ = us; }
+
+  uint32_t get_requests() const { return this->requests_; }
+  uint32_t get_writes() const { return this->writes_; }
+  uint32_t get_multi_writes() const { return this->multi_writes_; }
+
+  // UARTComponent
+  void write_array(const uint8_t *data, size_t len) override;
+  bool read_byte(uint8_t *data) override;
+  int available() override;
+  void flush() override;
+
+ protected:
+  static uint32_t key(uint8_t category, uint8_t page, uint8_t index) {
+    return ((uint32_t) category << 16) | ((uint32_t) page << 8) | index;
+  }
+  uint64_t byte_us() const { return 10000000ull / this->baud_rate_; }
+  void handle_request(const std::vector<uint8_t> &req);
+  void respond(std::vector<uint8_t> frame);
+  void release_ready();
+
+  std::map<uint32_t, uint16_t> registers_;
+  std::map<uint32_t, std::pair<uint16_t, uint16_t>> clamps_;
+  bool multi_write_{true};
+  bool silent_{false};
+  uint32_t drop_next_{0};
+  uint32_t drop_multi_writes_{0};
+  uint32_t turnaround_us_{5000};
+  uint64_t tx_done_us_{0};
+  std::deque<std::pair<uint64_t, uint8_t>> pending_;  // (time the byte is complete, byte)
+  std::deque<uint8_t> rx_;
+  uint32_t requests_{0};
+  uint32_t writes_{0};
+  uint32_t multi_writes_{0};
+};
+
+// Modbus CRC16 appended little-endian, as on the bus
+void append_crc(std::vector<uint8_t> &frame);
+
+}  // namespace testing
+}  // namespace wavinahc9000v3
+}  // namespace esphome
@@ -0,0 +1,52 @@
+#include "fault_uart.h"
+#include "host.h"
+
+namespace esphome {
+namespace wavinahc9000v3 {
+namespace testing {
+
+bool FaultUart::roll(float probability) {
+  if (probability <= 0.0f) return false;
+  return std::uniform_real_distribution<float>(0.0f, 1.0f)(this->rng_) < probability;
+}
+
+void FaultUart::write_array(const uint8_t *data, size_t len) {
+  // Leftovers of a silenced or truncated response must not leak into the next exchange
+  this->out_.clear();
+  this->inner_->write_array(data, len);
+  this->tx_us_ = host::now_us();
+  this->delivered_ = 0;
+  this->silent_ = this->roll(this->impairments_.silence_rate);
+  this->truncate_at_ = this->roll(this->impairments_.truncate_rate) ? 1 + this->rng_() % 8 : SIZE_MAX;
+  if (this->impairments_.tx_echo) this->out_.insert(this->out_.end(), data, data + len);
+}
+
+void FaultUart::pump() {
+  // Latency holds bytes back, so they still count against the hub's receive timeout
+  if (host::now_us() - this->tx_us_ < (uint64_t) this->impairments_.latency_ms * 1000) return;
+  uint8_t b;
+  while (this->inner_->read_byte(&b)) {
+    if (this->silent_ || this->delivered_ >= this->truncate_at_) continue;
+    if (this->roll(this->impairments_.drop_rate)) continue;
+    this->delivered_++;
+    if (this->roll(this->impairments_.bit_flip_rate)) b ^= (uint8_t) (1 << (this->rng_() % 8));
+    this->out_.push_back(b);
+  }
+}
+
+bool FaultUart::read_byte(uint8_t *data) {
+  this->pump();
+  if (this->out_.empty()) return false;
+  *data = this->out_.front();
+  this->out_.pop_front();
+  return true;
+}
+
+int FaultUart::available() {
+  this->pump();
+  return (int) this->out_.size();
+}
+
+}  // namespace testing
+}  // namespace wavinahc9000v3
+}  // namespace esphome
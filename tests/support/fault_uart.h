@@ -0,0 +1,54 @@
+#pragma once
+// Fault-injecting shim between the hub and another UART peer (normally FakeController). Impairs
+// what the hub receives the way a bad RS485 bus does; per-response faults are rolled when a request
+// goes out, per-byte faults as bytes pass. Seeded, so a scenario replays identically.
+#include "esphome/components/uart/uart.h"
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace esphome {
+namespace wavinahc9000v3 {
+namespace testing {
+
+struct Impairments {
+  const char *name{"clean"};
+  float drop_rate{0.0f};      // probability a received byte is lost
+  float bit_flip_rate{0.0f};  // probability a received byte has one bit inverted
+  float truncate_rate{0.0f};  // probability a response is cut short
+  float silence_rate{0.0f};   // probability a response never arrives
+  uint32_t latency_ms{0};     // extra delay before the first response byte is visible
+  bool tx_echo{false};        // the request is read back first (half-duplex transceiver echo)
+};
+
+class FaultUart : public uart::UARTComponent {
+ public:
+  FaultUart(uart::UARTComponent *inner, const Impairments &impairments, uint32_t seed = 1)
+      : inner_(inner), impairments_(impairments), rng_(seed) {
+    this->baud_rate_ = inner->get_baud_rate();
+  }
+
+  void write_array(const uint8_t *data, size_t len) override;
+  bool read_byte(uint8_t *data) override;
+  int available() override;
+  void flush() override { this->inner_->flush(); }
+
+ protected:
+  bool roll(float probability);
+  void pump();
+
+  uart::UARTComponent *inner_;
+  Impairments impairments_;
+  std::mt19937 rng_;
+  std::deque<uint8_t> out_;
+  uint64_t tx_us_{0};
+  size_t delivered_{0};
+  size_t truncate_at_{SIZE_MAX};
+  bool silent_{false};
+};
+
+}  // namespace testing
+}  // namespace wavinahc9000v3
+}  // namespace esphome
@@ -0,0 +1,87 @@
+#pragma once
+// Drives components the way App.loop() does: loop() on every iteration, update() of polling
+// components every update interval, iterations at least LOOP_INTERVAL_MS apart.
+#include "esphome/core/component.h"
+#include "host.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace esphome {
+namespace wavinahc9000v3 {
+namespace testing {
+
+class LoopRunner {
+ public:
+  static constexpr uint32_t LOOP_INTERVAL_MS = 16;
+
+  void add(Component *c) { this->components_.push_back(c); }
+  void add(PollingComponent *c) {
+    this->components_.push_back(c);
+    this->pollers_.push_back({c, 0});
+  }
+
+  void setup() {
+    for (auto *c : this->components_) c->setup();
+    for (auto &p : this->pollers_) p.next_ms = millis() + p.component->get_update_interval();
+  }
+
+  // Runs for ms of (host) time, or until done() returns true; returns whether done() did
+  bool run_for(uint32_t ms, const std::function<bool()> &done = nullptr) {
+    uint32_t end = millis() + ms;
+    while ((int32_t) (millis() - end) < 0) {
+      uint32_t start_us = micros();
+      for (auto *c : this->components_) c->loop();
+      for (auto &p : this->pollers_) {
+        if ((int32_t) (millis() - p.next_ms) < 0) continue;
+        p.component->update();
+        p.next_ms += p.component->get_update_interval();
+      }
+      uint32_t took_us = micros() - start_us;
+      this->max_iteration_us_ = std::max(this->max_iteration_us_, took_us);
+      if (done && done()) return true;
+      if (took_us < LOOP_INTERVAL_MS * 1000) delayMicroseconds(LOOP_INTERVAL_MS * 1000 - took_us);
+    }
+    return false;
+  }
+
+  uint32_t get_max_iteration_us() const { return this->max_iteration_us_; }
+  void reset_max_iteration() { this->max_iteration_us_ = 0; }
+
+ protected:
+  struct Poller {
+    PollingComponent *component;
+    uint32_t next_ms;
+  };
+  std::vector<Component *> components_;
+  std::vector<Poller> pollers_;
+  uint32_t max_iteration_us_{0};
+};
+
+// Minimal assertion helpers; failures are counted and reported, the test continues
+struct Checks {
+  int failures{0};
+  void expect(bool ok, const char *what, int line) {
+    if (ok) return;
+    std::fprintf(stderr, "FAIL line %d: %s\n", line, what);
+    this->failures++;
+  }
+  void near(float got, float want, float tol, const char *what, int line) {
+    if (std::fabs(got - want) <= tol) return;
+    std::fprintf(stderr, "FAIL line %d: %s = %.3f, expected %.3f\n", line, what, got, want);
+    this->failures++;
+  }
+  int result(const char *name) const {
+    if (this->failures == 0) std::printf("%s: all checks passed\n", name);
+    return this->failures == 0 ? 0 : 1;
+  }
+};
+#define EXPECT(checks, cond) (checks).expect((cond), #cond, __LINE__)
+#define EXPECT_NEAR(checks, got, want, tol) (checks).near((got), (want), (tol), #got, __LINE__)
+
+}  // namespace testing
+}  // namespace wavinahc9000v3
+}  // namespace esphome
@@ -0,0 +1,130 @@
+#include "replay_uart.h"
+#include "host.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace esphome {
+namespace wavinahc9000v3 {
+namespace testing {
+
+static bool parse_hex(const char *p, std::vector<uint8_t> &out) {
+  auto nibble = [](char c) -> int {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  };
+  for (; nibble(p[0]) >= 0; p += 2) {
+    if (nibble(p[1]) < 0) return false;
+    out.push_back((uint8_t) (nibble(p[0]) << 4 | nibble(p[1])));
+  }
+  return true;
+}
+
+bool ReplayUart::load(std::istream &in) {
+  struct Record {
+    uint32_t t_us;
+    bool rx;
+    bool timed_out;
+    std::vector<uint8_t> bytes;
+  };
+  std::vector<Record> records;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line[0] == '#') continue;
+    // Frame start: "+<10 digits> <TX|RX> <OK|TO|CRC> <hex>", continuation: "...<offset> <hex>"
+    size_t cont = line.find("...");
+    if (cont != std::string::npos && !records.empty()) {
+      const char *p = line.c_str() + cont + 3;
+      while (*p >= '0' && *p <= '9') p++;
+      if (*p == ' ') parse_hex(p + 1, records.back().bytes);
+      continue;
+    }
+    size_t plus = line.find('+');
+    while (plus != std::string::npos) {
+      const char *p = line.c_str() + plus + 1;
+      char *end = nullptr;
+      unsigned long t = std::strtoul(p, &end, 10);
+      if (end == p + 10 && (std::strncmp(end, " TX ", 4) == 0 || std::strncmp(end, " RX ", 4) == 0)) {
+        Record r{(uint32_t) t, end[1] == 'R', false, {}};
+        const char *outcome = end + 4;
+        r.timed_out = std::strncmp(outcome, "TO", 2) == 0;
+        const char *hex = std::strchr(outcome, ' ');
+        if (hex != nullptr) parse_hex(hex + 1, r.bytes);
+        records.push_back(std::move(r));
+        break;
+      }
+      plus = line.find('+', plus + 1);
+    }
+  }
+  // Pair each TX with the RX record that follows it
+  for (size_t i = 0; i < records.size(); i++) {
+    if (records[i].rx) continue;
+    Exchange ex;
+    ex.request = records[i].bytes;
+    if (i + 1 < records.size() && records[i + 1].rx) {
+      ex.response = records[i + 1].bytes;
+      ex.delay_us = records[i + 1].t_us - records[i].t_us;
+      ex.timed_out = records[i + 1].timed_out;
+      i++;
+    } else {
+      ex.timed_out = true;
+    }
+    this->exchanges_.push_back(std::move(ex));
+  }
+  return !this->exchanges_.empty();
+}
+
+size_t ReplayUart::get_used() const {
+  return (size_t) std::count_if(this->exchanges_.begin(), this->exchanges_.end(),
+                                [](const Exchange &e) { return e.used; });
+}
+
+void ReplayUart::write_array(const uint8_t *data, size_t len) {
+  std::vector<uint8_t> req(data, data + len);
+  Exchange *match = nullptr;
+  for (auto &ex : this->exchanges_) {
+    if (ex.request != req) continue;
+    match = &ex;
+    if (!ex.used) break;
+  }
+  if (match == nullptr) {
+    this->unmatched_.push_back(std::move(req));
+    return;
+  }
+  match->used = true;
+  // Spread the captured bytes over the captured delay; a timeout delivers its partial bytes early
+  uint64_t now = host::now_us();
+  size_t n = match->response.size();
+  for (size_t i = 0; i < n; i++) {
+    uint64_t at = match->timed_out ? now + (i + 1) * 1000 : now + match->delay_us * (i + 1) / n;
+    this->pending_.emplace_back(at, match->response[i]);
+  }
+}
+
+void ReplayUart::release_ready() {
+  uint64_t now = host::now_us();
+  while (!this->pending_.empty() && this->pending_.front().first <= now) {
+    this->rx_.push_back(this->pending_.front().second);
+    this->pending_.pop_front();
+  }
+}
+
+bool ReplayUart::read_byte(uint8_t *data) {
+  this->release_ready();
+  if (this->rx_.empty()) return false;
+  *data = this->rx_.front();
+  this->rx_.pop_front();
+  return true;
+}
+
+int ReplayUart::available() {
+  this->release_ready();
+  return (int) this->rx_.size();
+}
+
+}  // namespace testing
+}  // namespace wavinahc9000v3
+}  // namespace esphome
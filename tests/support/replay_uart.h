@@ -0,0 +1,52 @@
+#pragma once
+// Replays a bus capture in the format of WavinAHC9000::dump_bus_trace() (device log lines pasted
+// as-is, logger prefixes and all). Each request the hub sends is matched to the next unused exchange
+// with the same request bytes, and the captured response bytes are delivered after the captured
+// response delay. An exchange that timed out delivers only the partial bytes it captured. Once
+// every capture of a request was used, the last one answers again, so a capture of one sweep can
+// serve repeated polls.
+#include "esphome/components/uart/uart.h"
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace wavinahc9000v3 {
+namespace testing {
+
+class ReplayUart : public uart::UARTComponent {
+ public:
+  struct Exchange {
+    std::vector<uint8_t> request;
+    std::vector<uint8_t> response;
+    uint32_t delay_us{0};  // request TX to end of response (or timeout)
+    bool timed_out{false};
+    bool used{false};
+  };
+
+  // Returns false if the capture holds no exchange
+  bool load(std::istream &in);
+  const std::vector<Exchange> &get_exchanges() const { return this->exchanges_; }
+  // Requests no capture matched; they go unanswered
+  const std::vector<std::vector<uint8_t>> &get_unmatched() const { return this->unmatched_; }
+  size_t get_used() const;
+
+  void write_array(const uint8_t *data, size_t len) override;
+  bool read_byte(uint8_t *data) override;
+  int available() override;
+
+ protected:
+  void release_ready();
+
+  std::vector<Exchange> exchanges_;
+  std::vector<std::vector<uint8_t>> unmatched_;
+  std::deque<std::pair<uint64_t, uint8_t>> pending_;
+  std::deque<uint8_t> rx_;
+};
+
+}  // namespace testing
+}  // namespace wavinahc9000v3
+}  // namespace esphome
@@ -0,0 +1,75 @@
+// Write elision against the register shadow: a write of the value just read never reaches the bus,
+// a different value does, an identical write while another value for the field is in flight is
+// sent (it has to override that one), and a shadow older than write_elision_max_age is not trusted.
+#include "wavin_ahc9000.h"
+#include "esphome/core/log.h"
+#include "fake_controller.h"
+#include "loop_runner.h"
+
+using namespace esphome;
+using namespace esphome::wavinahc9000v3;
+using namespace esphome::wavinahc9000v3::testing;
+
+static constexpr uint8_t SETPOINT = 0x00;
+
+struct Rig {
+  FakeController controller;
+  WavinAHC9000 hub;
+  LoopRunner runner;
+
+  explicit Rig(uint32_t update_interval_ms) {
+    this->controller.set_zone(1, FakeController::Zone{});
+    this->hub.set_uart_parent(&this->controller);
+    this->hub.set_update_interval(update_interval_ms);
+    this->hub.add_active_channel(1);
+    this->hub.set_write_elision_max_age_ms(60000);
+    this->runner.add(&this->hub);
+    this->runner.setup();
+    this->runner.run_for(10000, [this] { return this->hub.get_last_sweep_stats().transactions != 0; });
+  }
+
+  uint16_t setpoint_register() { return this->controller.get_register(FakeController::CAT_PACKED, 0, SETPOINT); }
+};
+
+int main() {
+  host::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  Checks c;
+
+  {
+    host::reset_clock();
+    Rig rig(5000);
+    // The controller holds 21.0 °C, read moments ago
+    uint32_t requests = rig.controller.get_requests();
+    rig.hub.write_channel_setpoint(1, 21.0f);
+    rig.hub.write_channel_standby_setpoint(1, 16.0f);
+    rig.runner.run_for(200);
+    EXPECT(c, rig.hub.get_writes_elided() == 2);
+    EXPECT(c, rig.controller.get_writes() == 0);
+    EXPECT(c, rig.controller.get_requests() == requests);
+
+    rig.hub.write_channel_setpoint(1, 22.0f);
+    EXPECT(c, rig.runner.run_for(10000, [&] { return rig.setpoint_register() == 220; }));
+    EXPECT(c, rig.controller.get_writes() == 1);
+
+    // 23.0 is pending when 22.0 comes back: the cache still reads 22.0, but the write must go out
+    rig.runner.run_for(5000);
+    rig.hub.write_channel_setpoint(1, 23.0f);
+    rig.hub.write_channel_setpoint(1, 22.0f);
+    EXPECT(c, rig.runner.run_for(10000, [&] { return rig.controller.get_writes() >= 2; }));
+    rig.runner.run_for(5000);
+    EXPECT(c, rig.setpoint_register() == 220);
+    EXPECT(c, rig.hub.get_writes_elided() == 2);
+  }
+
+  {
+    host::reset_clock();
+    // Polled every 5 minutes: the shadow ages past write_elision_max_age between reads
+    Rig rig(300000);
+    rig.runner.run_for(61000);
+    rig.hub.write_channel_setpoint(1, 21.0f);
+    EXPECT(c, rig.runner.run_for(10000, [&] { return rig.controller.get_writes() == 1; }));
+    EXPECT(c, rig.hub.get_writes_elided() == 0);
+  }
+
+  return c.result("write_elision");
+}